@@ -0,0 +1,366 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       AsyncLaserDriver.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#include <assert.h>
+#include "AsyncLaserDriver.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * Time a request may wait in its lane before it is promoted to the next more urgent lane.
+ */
+const int g_MaxQueueingTimeMs = 500;
+
+AsyncLaserDriver::AsyncLaserDriver( LaserDriver* wireDriver, const Logger* logger ) :
+    wireDriver_( wireDriver ),
+    logger_( logger ),
+    inFlightRequest_( NULL ),
+    isStopRequested_( false )
+{
+    assert( wireDriver_ != NULL );
+
+    // Holding the lock keeps the I/O thread from running until its id has been recorded:
+    std::lock_guard<std::mutex> lock( mutex_ );
+    ioThread_ = std::thread( &AsyncLaserDriver::Run, this );
+    ioThreadId_ = ioThread_.get_id();
+}
+
+AsyncLaserDriver::~AsyncLaserDriver()
+{
+    Stop();
+}
+
+void AsyncLaserDriver::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        isStopRequested_ = true;
+    }
+
+    requestAvailable_.notify_all();
+
+    if ( ioThread_.joinable() && !IsIoThread() ) {
+        ioThread_.join();
+    }
+}
+
+std::future<AsyncLaserDriver::CommandResult> AsyncLaserDriver::SubmitCommand( const std::string& command, Priority priority )
+{
+    return SubmitCommand( command, priority, true );
+}
+
+std::future<AsyncLaserDriver::CommandResult> AsyncLaserDriver::SubmitCommand( const std::string& command, Priority priority, const bool isReplyWanted )
+{
+    Request* request = new Request();
+    request->command = command;
+    request->priority = priority;
+    request->isReplyWanted = isReplyWanted;
+
+    std::future<CommandResult> result = request->promise.get_future();
+    Enqueue( request );
+    
+    return result;
+}
+
+int AsyncLaserDriver::SendCommand( const std::string& command, std::string* response )
+{
+    return SendCommand( command, response, Setpoint );
+}
+
+/**
+ * \brief Synchronous wrapper: submits the command and blocks until the I/O thread has completed it.
+ */
+int AsyncLaserDriver::SendCommand( const std::string& command, std::string* response, Priority priority )
+{
+    // Commands issued from within a completion callback must not wait for the queue they are run by:
+    if ( IsIoThread() ) {
+        return wireDriver_->SendCommand( command, response );
+    }
+
+    CommandResult result = SubmitCommand( command, priority, ( response != NULL ) ).get();
+
+    if ( response != NULL ) {
+        response->swap( result.response );
+    }
+
+    return result.returnCode;
+}
+
+/**
+ * \brief Hands the whole batch to the I/O thread as one request, so that no other command can end up
+ *        between the pipelined commands and their replies.
+ */
+int AsyncLaserDriver::SendCommandBatch( command_batch_t& batch )
+{
+    return SendCommandBatch( batch, Setpoint );
+}
+
+int AsyncLaserDriver::SendCommandBatch( command_batch_t& batch, Priority priority )
+{
+    if ( IsIoThread() ) {
+        return wireDriver_->SendCommandBatch( batch );
+    }
+
+    Request* request = new Request();
+    request->batch = &batch;
+    request->priority = priority;
+
+    std::future<CommandResult> result = request->promise.get_future();
+    Enqueue( request );
+
+    return result.get().returnCode;
+}
+
+void AsyncLaserDriver::SendCommandAsync( const std::string& command, Completion* completion, Priority priority )
+{
+    Request* request = new Request();
+    request->command = command;
+    request->completion = completion;
+    request->priority = priority;
+    request->isReplyWanted = ( completion != NULL );
+
+    Enqueue( request );
+}
+
+void AsyncLaserDriver::Enqueue( Request* request )
+{
+    bool isAccepted = false;
+    
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+
+        if ( !isStopRequested_ ) {
+
+            request->enqueueTime = clock_t::now();
+
+            if ( !MergeIntoPendingRequest( request ) ) {
+                lanes_[ request->priority ].push_back( request );
+            }
+
+            isAccepted = true;
+        }
+    }
+    
+    if ( !isAccepted ) {
+
+        logger_->LogError( "AsyncLaserDriver::Enqueue(): I/O thread stopped, rejected command '" + request->command + "'" );
+        Complete( request, CommandResult() );
+        return;
+    }
+
+    requestAvailable_.notify_one();
+}
+
+bool AsyncLaserDriver::IsQuery( const Request* request )
+{
+    return ( request->batch == NULL && request->command.length() > 0 &&
+             request->command[ request->command.length() - 1 ] == '?' );
+}
+
+/**
+ * \brief Attaches a query to an identical query already on the wire or waiting in any lane, if there
+ *        is one. A waiting query is moved up to the lane of the more urgent of the two. Must be
+ *        called with mutex_ held.
+ */
+bool AsyncLaserDriver::MergeIntoPendingRequest( Request* request )
+{
+    if ( !IsQuery( request ) ) {
+        return false;
+    }
+
+    // The reply of a query on the wire without a reply wanted is lost already:
+    if ( inFlightRequest_ != NULL && IsQuery( inFlightRequest_ ) && inFlightRequest_->command == request->command &&
+         ( inFlightRequest_->isReplyWanted || !request->isReplyWanted ) ) {
+
+        inFlightRequest_->mergedRequests.push_back( request );
+        return true;
+    }
+
+    for ( int priority = 0; priority < PriorityCount; priority++ ) {
+
+        lane_t& lane = lanes_[ priority ];
+
+        for ( lane_t::iterator waitingRequest = lane.begin(); waitingRequest != lane.end(); waitingRequest++ ) {
+
+            if ( !IsQuery( *waitingRequest ) || ( *waitingRequest )->command != request->command ) {
+                continue;
+            }
+
+            Request* sharedRequest = *waitingRequest;
+            sharedRequest->mergedRequests.push_back( request );
+            sharedRequest->isReplyWanted = ( sharedRequest->isReplyWanted || request->isReplyWanted );
+
+            if ( request->priority < sharedRequest->priority ) {
+
+                lane.erase( waitingRequest );
+                sharedRequest->priority = request->priority;
+                lanes_[ sharedRequest->priority ].push_back( sharedRequest );
+            }
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Moves requests that have waited too long to the tail of the next more urgent lane, but never
+ *        into the Emission lane, so that aged telemetry cannot delay shutter commands. Must be called
+ *        with mutex_ held.
+ */
+void AsyncLaserDriver::PromoteAgedRequests()
+{
+    const clock_t::time_point agingLimit = clock_t::now() - std::chrono::milliseconds( g_MaxQueueingTimeMs );
+
+    for ( int priority = Setpoint + 1; priority < PriorityCount; priority++ ) {
+
+        lane_t& lane = lanes_[ priority ];
+
+        while ( !lane.empty() && lane.front()->enqueueTime < agingLimit ) {
+
+            Request* request = lane.front();
+            lane.pop_front();
+
+            request->priority = (Priority) ( priority - 1 );
+            request->enqueueTime = clock_t::now();
+            lanes_[ request->priority ].push_back( request );
+        }
+    }
+}
+
+/**
+ * \brief Must be called with mutex_ held.
+ */
+AsyncLaserDriver::Request* AsyncLaserDriver::DequeueMostUrgent()
+{
+    PromoteAgedRequests();
+
+    for ( int priority = 0; priority < PriorityCount; priority++ ) {
+
+        if ( !lanes_[ priority ].empty() ) {
+
+            Request* request = lanes_[ priority ].front();
+            lanes_[ priority ].pop_front();
+            return request;
+        }
+    }
+
+    return NULL;
+}
+
+AsyncLaserDriver::CommandResult AsyncLaserDriver::Execute( Request* request )
+{
+    CommandResult result;
+
+    if ( request->batch != NULL ) {
+        result.returnCode = wireDriver_->SendCommandBatch( *request->batch );
+    } else {
+        result.returnCode = wireDriver_->SendCommand( request->command, ( request->isReplyWanted ? &result.response : NULL ) );
+    }
+
+    return result;
+}
+
+void AsyncLaserDriver::Complete( Request* request, const CommandResult& result )
+{
+    for ( std::vector<Request*>::iterator mergedRequest = request->mergedRequests.begin();
+          mergedRequest != request->mergedRequests.end();
+          mergedRequest++ ) {
+
+        Complete( *mergedRequest, result );
+    }
+
+    if ( request->completion != NULL ) {
+        request->completion->OnCommandCompleted( request->command, result.returnCode, result.response );
+    }
+
+    request->promise.set_value( result );
+
+    delete request;
+}
+
+bool AsyncLaserDriver::IsIoThread() const
+{
+    return ( std::this_thread::get_id() == ioThreadId_ );
+}
+
+void AsyncLaserDriver::Run()
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    while ( true ) {
+
+        Request* request = NULL;
+
+        while ( !isStopRequested_ && ( request = DequeueMostUrgent() ) == NULL ) {
+            requestAvailable_.wait( lock );
+        }
+
+        if ( isStopRequested_ ) {
+            break;
+        }
+
+        inFlightRequest_ = request;
+        lock.unlock();
+
+        const CommandResult result = Execute( request );
+
+        // No more requests may be merged into the in-flight one once its reply is being handed out:
+        lock.lock();
+        inFlightRequest_ = NULL;
+        lock.unlock();
+
+        Complete( request, result );
+        lock.lock();
+    }
+
+    std::vector<Request*> abandonedRequests;
+
+    for ( int priority = 0; priority < PriorityCount; priority++ ) {
+
+        abandonedRequests.insert( abandonedRequests.end(), lanes_[ priority ].begin(), lanes_[ priority ].end() );
+        lanes_[ priority ].clear();
+    }
+
+    lock.unlock();
+
+    for ( std::vector<Request*>::iterator request = abandonedRequests.begin(); request != abandonedRequests.end(); request++ ) {
+        Complete( *request, CommandResult() );
+    }
+}
+
+NAMESPACE_COBOLT_END
@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       AsyncLaserDriver.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__ASYNC_LASER_DRIVER_H
+#define __COBOLT__ASYNC_LASER_DRIVER_H
+
+#include <chrono>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+#include "base.h"
+#include "LaserDriver.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Owns a dedicated I/O thread through which all traffic to the wrapped (wire level) driver
+ *        is funneled. Commands are submitted to a queue and completed through futures or
+ *        completion callbacks, while the LaserDriver API remains available as a synchronous
+ *        wrapper on top of the queue.
+ *
+ * The queue has one lane per LaserDriver::Priority, and a more urgent lane is always served first.
+ * Thus a shutter command only has to wait for the command currently on the wire, not for all the
+ * telemetry queries submitted before it. Telemetry that has waited too long is promoted to the
+ * setpoint lane so that it cannot starve; nothing is ever promoted into the emission lane.
+ *
+ * Queries (commands ending with '?') are single-flight: a query identical to one that is already
+ * waiting or on the wire is attached to it instead of being sent again, and all callers share its
+ * reply. Thus N concurrent readers of the same value cost one round trip.
+ */
+class AsyncLaserDriver : public LaserDriver
+{
+public:
+
+    struct CommandResult
+    {
+        CommandResult() : returnCode( return_code::error ) {}
+
+        int returnCode;
+        std::string response;
+    };
+
+    AsyncLaserDriver( LaserDriver* wireDriver, const Logger* logger );
+    virtual ~AsyncLaserDriver();
+
+    /**
+     * \brief Stops the I/O thread. Commands still waiting in the queue are completed with
+     *        return_code::error. Any later submission fails immediately.
+     */
+    void Stop();
+
+    std::future<CommandResult> SubmitCommand( const std::string& command, Priority priority = Telemetry );
+
+    /// ###
+    /// LaserDriver API
+
+    virtual int SendCommand( const std::string& command, std::string* response = NULL );
+    virtual int SendCommand( const std::string& command, std::string* response, Priority priority );
+    virtual int SendCommandBatch( command_batch_t& batch );
+    virtual int SendCommandBatch( command_batch_t& batch, Priority priority );
+    virtual void SendCommandAsync( const std::string& command, Completion* completion, Priority priority = Telemetry );
+
+private:
+
+    typedef std::chrono::steady_clock clock_t;
+
+    struct Request
+    {
+        Request() : batch( NULL ), completion( NULL ), priority( Setpoint ), isReplyWanted( true ) {}
+
+        std::string command;
+        command_batch_t* batch;
+        Completion* completion;
+        Priority priority;
+
+        /**
+         * False for commands sent with a NULL response, which are handed to the wire driver as such,
+         * leaving it to the wire driver whether to wait for and classify the reply.
+         */
+        bool isReplyWanted;
+        clock_t::time_point enqueueTime;
+        std::promise<CommandResult> promise;
+
+        /**
+         * Identical requests merged into this one, completed with the result of this one.
+         */
+        std::vector<Request*> mergedRequests;
+    };
+
+    typedef std::deque<Request*> lane_t;
+
+    static bool IsQuery( const Request* request );
+
+    std::future<CommandResult> SubmitCommand( const std::string& command, Priority priority, bool isReplyWanted );
+
+    void Enqueue( Request* request );
+    bool MergeIntoPendingRequest( Request* request );
+    void PromoteAgedRequests();
+    Request* DequeueMostUrgent();
+
+    CommandResult Execute( Request* request );
+    void Complete( Request* request, const CommandResult& result );
+    bool IsIoThread() const;
+
+    void Run();
+
+    LaserDriver* wireDriver_;
+    const Logger* logger_;
+
+    std::mutex mutex_;
+    std::condition_variable requestAvailable_;
+    lane_t lanes_[ PriorityCount ];
+    Request* inFlightRequest_;
+    bool isStopRequested_;
+
+    std::thread ioThread_;
+    std::thread::id ioThreadId_;
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__ASYNC_LASER_DRIVER_H
\ No newline at end of file
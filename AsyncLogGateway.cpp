@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       AsyncLogGateway.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#include <assert.h>
+#include <chrono>
+#include <string.h>
+#include "AsyncLogGateway.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+const int g_DrainIntervalMs = 10;
+
+AsyncLogGateway::AsyncLogGateway( const Logger::Gateway* target ) :
+    target_( target ),
+    writePosition_( 0 ),
+    readPosition_( 0 ),
+    droppedMessageCount_( 0 ),
+    reportedDroppedMessageCount_( 0 ),
+    isStopRequested_( false )
+{
+    assert( target_ != NULL );
+
+    for ( size_t i = 0; i < SlotCount; i++ ) {
+        slots_[ i ].sequence.store( i, std::memory_order_relaxed );
+    }
+
+    drainThread_ = std::thread( &AsyncLogGateway::Run, this );
+}
+
+AsyncLogGateway::~AsyncLogGateway()
+{
+    Stop();
+}
+
+void AsyncLogGateway::SendLogMessage( const char* message, bool debug ) const
+{
+    size_t position = writePosition_.load( std::memory_order_relaxed );
+    Slot* slot;
+
+    // A slot is free for position p when its sequence number is p, and filled when it is p + 1:
+    while ( true ) {
+
+        slot = &slots_[ position & ( SlotCount - 1 ) ];
+        const size_t sequence = slot->sequence.load( std::memory_order_acquire );
+
+        if ( sequence == position ) {
+
+            if ( writePosition_.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) ) {
+                break;
+            }
+
+        } else if ( sequence < position ) {
+
+            droppedMessageCount_.fetch_add( 1, std::memory_order_relaxed );
+            return;
+
+        } else {
+
+            position = writePosition_.load( std::memory_order_relaxed );
+        }
+    }
+
+    slot->debug = debug;
+    strncpy( slot->message, message, MessageCapacity - 1 );
+    slot->message[ MessageCapacity - 1 ] = '\0';
+
+    slot->sequence.store( position + 1, std::memory_order_release );
+}
+
+void AsyncLogGateway::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        isStopRequested_ = true;
+    }
+
+    stopRequested_.notify_all();
+
+    if ( drainThread_.joinable() ) {
+        drainThread_.join();
+    }
+}
+
+unsigned long AsyncLogGateway::GetDroppedMessageCount() const
+{
+    return droppedMessageCount_.load( std::memory_order_relaxed );
+}
+
+/**
+ * \brief Forwards the oldest message, if any. Only called by the drain thread.
+ */
+bool AsyncLogGateway::Forward()
+{
+    Slot& slot = slots_[ readPosition_ & ( SlotCount - 1 ) ];
+
+    if ( slot.sequence.load( std::memory_order_acquire ) != readPosition_ + 1 ) {
+        return false;
+    }
+
+    target_->SendLogMessage( slot.message, slot.debug );
+
+    slot.sequence.store( readPosition_ + SlotCount, std::memory_order_release );
+    readPosition_++;
+
+    return true;
+}
+
+void AsyncLogGateway::Run()
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    while ( true ) {
+
+        const bool isStopping = isStopRequested_;
+
+        lock.unlock();
+
+        while ( Forward() ) {}
+
+        const unsigned long droppedMessageCount = droppedMessageCount_.load( std::memory_order_relaxed );
+
+        if ( droppedMessageCount != reportedDroppedMessageCount_ ) {
+
+            const std::string report = "AsyncLogGateway: Log buffer full, dropped " +
+                std::to_string( (long long) ( droppedMessageCount - reportedDroppedMessageCount_ ) ) + " message(s)";
+            target_->SendLogMessage( report.c_str(), false );
+            reportedDroppedMessageCount_ = droppedMessageCount;
+        }
+
+        lock.lock();
+
+        if ( isStopping ) {
+            break;
+        }
+
+        if ( !isStopRequested_ ) {
+            stopRequested_.wait_for( lock, std::chrono::milliseconds( g_DrainIntervalMs ) );
+        }
+    }
+}
+
+NAMESPACE_COBOLT_END
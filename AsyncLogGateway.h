@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       AsyncLogGateway.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__ASYNC_LOG_GATEWAY_H
+#define __COBOLT__ASYNC_LOG_GATEWAY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "base.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Log gateway that queues messages in a bounded ring buffer and forwards them to another
+ *        gateway from a background thread, so that logging threads never wait for the log file.
+ *
+ * Any thread may log. Claiming a slot is a compare-and-swap on the write position, and nothing is
+ * allocated once the gateway exists. When the buffer is full the message is dropped and counted,
+ * and the number of dropped messages is logged once there is room again. Messages longer than
+ * MessageCapacity are truncated.
+ */
+class AsyncLogGateway : public Logger::Gateway
+{
+public:
+
+    static const size_t SlotCount = 256; // Must be a power of two.
+    static const size_t MessageCapacity = 1024;
+
+    AsyncLogGateway( const Logger::Gateway* target );
+    virtual ~AsyncLogGateway();
+
+    virtual void SendLogMessage( const char* message, bool debug ) const;
+
+    /**
+     * \brief Forwards the messages still in the buffer and stops the drain thread.
+     */
+    void Stop();
+
+    unsigned long GetDroppedMessageCount() const;
+
+private:
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        bool debug;
+        char message[ MessageCapacity ];
+    };
+
+    bool Forward();
+    void Run();
+
+    const Logger::Gateway* target_;
+
+    mutable Slot slots_[ SlotCount ];
+    mutable std::atomic<size_t> writePosition_;
+    size_t readPosition_;
+
+    mutable std::atomic<unsigned long> droppedMessageCount_;
+    unsigned long reportedDroppedMessageCount_;
+
+    std::mutex mutex_;
+    std::condition_variable stopRequested_;
+    bool isStopRequested_;
+    std::thread drainThread_;
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__ASYNC_LOG_GATEWAY_H
\ No newline at end of file
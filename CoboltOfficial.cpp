@@ -35,6 +35,9 @@
 //
 
 #include "CoboltOfficial.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
 
 using namespace std;
 using namespace cobolt;
@@ -44,6 +47,64 @@ const char * g_DeviceDescription = "Official device adapter for Cobolt lasers.";
 const char * g_DeviceVendorName = "Cobolt - a HBNER Group company";
 
 const char* const g_Property_Port_None = "None";
+const char* const g_Property_TelemetryPollInterval = "Telemetry Poll Interval [ms]";
+const char* const g_Property_WarmStartCacheFile = "Warm Start Cache File";
+const char* const g_Property_BackgroundInitialization = "Background Initialization";
+const char* const g_Property_BackgroundInitialization_Off = "Off";
+const char* const g_Property_BackgroundInitialization_On = "On";
+const char* const g_Property_SetpointWriteBehind = "Setpoint Write-Behind";
+const char* const g_Property_SetpointWriteBehind_Off = "Off";
+const char* const g_Property_SetpointWriteBehind_On = "On";
+const char* const g_Property_DebugLogging = "Debug Logging";
+const char* const g_Property_DebugLogging_Off = "Off";
+const char* const g_Property_DebugLogging_On = "On";
+const char* const g_Property_TraceFile = "Trace File";
+const char* const g_Property_ReplayTraceFile = "Replay Trace File";
+const char* const g_Property_ReplayTiming = "Replay Timing";
+const char* const g_Property_ReplayTiming_Original = "Original";
+const char* const g_Property_ReplayTiming_Compressed = "Compressed";
+const char* const g_Property_Statistics_Commands = "Statistics: Commands";
+const char* const g_Property_Statistics_Errors = "Statistics: Errors";
+const char* const g_Property_Statistics_Timeouts = "Statistics: Timeouts";
+const char* const g_Property_Statistics_LatencyP50 = "Statistics: Latency p50 [us]";
+const char* const g_Property_Statistics_LatencyP95 = "Statistics: Latency p95 [us]";
+const char* const g_Property_Statistics_LatencyP99 = "Statistics: Latency p99 [us]";
+const char* const g_Property_Statistics_LatencyMax = "Statistics: Latency Max [us]";
+const char* const g_Property_Statistics_BusiestCommands = "Statistics: Busiest Commands";
+const char* const g_Property_Statistics_DumpFile = "Statistics: Dump to File";
+
+/**
+ * Maximum number of commands written ahead of their replies when pipelining a command batch. Keeps
+ * us well within the input buffer of the laser.
+ */
+const size_t g_MaxPipelineDepth = 8;
+
+/**
+ * One lock per serial port, serializing the command/response exchanges of all devices on the port.
+ */
+std::mutex g_PortMutexesMutex;
+std::map<std::string, std::mutex> g_PortMutexes;
+
+std::mutex* GetPortMutex( const std::string& port )
+{
+    std::lock_guard<std::mutex> lock( g_PortMutexesMutex );
+    return &g_PortMutexes[ port ];
+}
+
+long GetMicrosecondsSince( const std::chrono::steady_clock::time_point& start )
+{
+    return (long) std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count();
+}
+
+CommandStatistics::Outcome ResolveCommandOutcome( const int returnCode )
+{
+    // Not returned by the serial port itself, but kept in case another port device reports its timeouts with it:
+    if ( returnCode == DEVICE_SERIAL_TIMEOUT ) {
+        return CommandStatistics::Timeout;
+    }
+
+    return CommandStatistics::ResolveOutcome( returnCode );
+}
 
 /// ###
 /// DLL API Exports
@@ -89,12 +150,26 @@ private:
 /// CoboltOfficial Implementation
 
 CoboltOfficial::CoboltOfficial() :
+    logGateway_( NULL ),
+    laserDriver_( NULL ),
+    warmStartDriver_( NULL ),
+    replayDriver_( NULL ),
     laser_( NULL ),
+    telemetryPoller_( NULL ),
     isInitialized_( false ),
     isBusy_( false ),
-    port_( "None" )
+    port_( "None" ),
+    portMutex_( NULL ),
+    telemetryPollIntervalMs_( 0 ),
+    isReplayTimingCompressed_( false ),
+    isBackgroundInitializationEnabled_( false ),
+    isSetpointWriteBehindEnabled_( false ),
+    isHydrating_( false ),
+    isHydrationStopRequested_( false )
 {
-    cobolt::Logger::Instance()->SetupWithGateway( this ); // TODO: Must be one instance per device.
+    // Log messages are forwarded to the core by a background thread, so that I/O never waits for the log file:
+    logGateway_ = new cobolt::AsyncLogGateway( this );
+    logger_.SetupWithGateway( logGateway_ );
     
     assert( strlen( g_DeviceName ) < (unsigned int) MM::MaxStrLength );
 
@@ -112,6 +187,7 @@ CoboltOfficial::CoboltOfficial() :
     SetErrorText( cobolt::return_code::serial_port_undefined,                   "No valid serial port selected." );
     SetErrorText( cobolt::return_code::property_not_settable_in_current_state,  "Change of this property not allowed in current state." );
     SetErrorText( cobolt::return_code::unsupported_device_property_value,       "Unsupported device response." );
+    SetErrorText( cobolt::return_code::serial_port_timeout,                     "No reply from the laser."       );
     
     // Create non-laser properties:
     CreateProperty( MM::g_Keyword_Name,         g_DeviceName,               MM::String, true );
@@ -119,6 +195,38 @@ CoboltOfficial::CoboltOfficial() :
     CreateProperty( MM::g_Keyword_Description,  g_DeviceDescription,        MM::String, true );
     CreateProperty( MM::g_Keyword_Port,         g_Property_Port_None,       MM::String, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_Port ), true );
     
+    // Poll interval of the volatile readings (power, current, laser state), 0 = query the laser on every read:
+    CreateProperty( g_Property_TelemetryPollInterval, "0", MM::Integer, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_TelemetryPollInterval ), true );
+    SetPropertyLimits( g_Property_TelemetryPollInterval, 0, 10000 );
+
+    // File keeping the immutable laser data between sessions, empty = always read it from the laser:
+    CreateProperty( g_Property_WarmStartCacheFile, "", MM::String, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_WarmStartCacheFile ), true );
+
+    // Whether initialization returns before the laser property values have been read (Busy() until they have):
+    CreateProperty( g_Property_BackgroundInitialization, g_Property_BackgroundInitialization_Off, MM::String, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_BackgroundInitialization ), true );
+    AddAllowedValue( g_Property_BackgroundInitialization, g_Property_BackgroundInitialization_Off );
+    AddAllowedValue( g_Property_BackgroundInitialization, g_Property_BackgroundInitialization_On );
+
+    // Whether power and current sets return before the laser has confirmed them (for responsive GUI sliders):
+    CreateProperty( g_Property_SetpointWriteBehind, g_Property_SetpointWriteBehind_Off, MM::String, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_SetpointWriteBehind ), true );
+    AddAllowedValue( g_Property_SetpointWriteBehind, g_Property_SetpointWriteBehind_Off );
+    AddAllowedValue( g_Property_SetpointWriteBehind, g_Property_SetpointWriteBehind_On );
+
+    // Whether the per-command debug messages are formatted and sent to the core at all (the core still
+    // applies its own debug log setting), switch off to spare the I/O path the formatting:
+    CreateProperty( g_Property_DebugLogging, g_Property_DebugLogging_On, MM::String, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_DebugLogging ) );
+    AddAllowedValue( g_Property_DebugLogging, g_Property_DebugLogging_Off );
+    AddAllowedValue( g_Property_DebugLogging, g_Property_DebugLogging_On );
+
+    // Binary trace of all command exchanges, empty = no tracing:
+    CreateProperty( g_Property_TraceFile, "", MM::String, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_TraceFile ), true );
+
+    // Trace to play back instead of talking to a laser (no port needed), empty = use the port:
+    CreateProperty( g_Property_ReplayTraceFile, "", MM::String, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_ReplayTraceFile ), true );
+    CreateProperty( g_Property_ReplayTiming, g_Property_ReplayTiming_Original, MM::String, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_ReplayTiming ), true );
+    AddAllowedValue( g_Property_ReplayTiming, g_Property_ReplayTiming_Original );
+    AddAllowedValue( g_Property_ReplayTiming, g_Property_ReplayTiming_Compressed );
+    
     UpdateStatus();
 }
 
@@ -126,10 +234,13 @@ CoboltOfficial::~CoboltOfficial()
 {
     Shutdown();
 
-    if ( laser_ != NULL ) {
-        delete laser_;
-        laser_ = NULL;
+    if ( replayDriver_ != NULL ) {
+        delete replayDriver_;
+        replayDriver_ = NULL;
     }
+
+    logger_.SetupWithGateway( NULL );
+    delete logGateway_;
 }
 
 int CoboltOfficial::Initialize()
@@ -138,30 +249,116 @@ int CoboltOfficial::Initialize()
         return cobolt::return_code::ok;
     }
 
-    if ( port_ == g_Property_Port_None ) {
+    // Left over from a previous initialization that failed half way:
+    TearDown();
 
-        Logger::Instance()->LogError( "CoboltOfficial::Initialize(): Serial port not selected" );
-        return cobolt::return_code::serial_port_undefined;
+    LaserDriver* wireDriver = this;
+
+    if ( replayTraceFile_.length() > 0 ) {
+
+        if ( replayDriver_ == NULL ) {
+            replayDriver_ = new ReplayLaserDriver( ( isReplayTimingCompressed_ ? 0.0 : 1.0 ), &logger_ );
+        }
+
+        if ( replayDriver_->Load( replayTraceFile_ ) != cobolt::return_code::ok ) {
+            return cobolt::return_code::error;
+        }
+
+        wireDriver = replayDriver_;
+
+    } else {
+
+        if ( port_ == g_Property_Port_None ) {
+
+            logger_.LogError( "CoboltOfficial::Initialize(): Serial port not selected" );
+            return cobolt::return_code::serial_port_undefined;
+        }
+
+        portMutex_ = GetPortMutex( port_ );
+
+        if ( traceFile_.length() > 0 && traceRecorder_.Open( traceFile_ ) != cobolt::return_code::ok ) {
+            logger_.LogError( "CoboltOfficial::Initialize(): Failed to open trace file '" + traceFile_ + "'" );
+        }
     }
 
     // Make sure 'device mode' is selected:
     //SendCommand( "1" );
 
-    laser_ = LaserFactory::Create( this );
+    if ( laserDriver_ == NULL ) {
+        laserDriver_ = new AsyncLaserDriver( wireDriver, &logger_ );
+    }
+
+    LaserDriver* laserDriver = laserDriver_;
+
+    if ( warmStartCacheFile_.length() > 0 ) {
+
+        if ( warmStartDriver_ == NULL ) {
+            warmStartDriver_ = new WarmStartLaserDriver( laserDriver_, warmStartCacheFile_, &logger_ );
+        }
+
+        if ( warmStartDriver_->Validate() == cobolt::return_code::ok ) {
+
+            laserDriver = warmStartDriver_;
+
+        } else {
+
+            // Without knowing which unit is connected the cache cannot be trusted, thus go without it:
+            logger_.LogError( "CoboltOfficial::Initialize(): Warm start cache file '" + warmStartCacheFile_ + "' not used, as the laser could not be identified" );
+            delete warmStartDriver_;
+            warmStartDriver_ = NULL;
+        }
+    }
+
+    laser_ = LaserFactory::Create( laserDriver, &logger_ );
 
     if ( laser_ == NULL ) {
         return cobolt::return_code::error;
     }
 
+    if ( isSetpointWriteBehindEnabled_ ) {
+        laser_->EnableSetpointWriteBehind( this );
+    }
+
+    if ( telemetryPollIntervalMs_ > 0 ) {
+
+        telemetryPoller_ = new TelemetryPoller( laserDriver_, telemetryPollIntervalMs_, &logger_ );
+        laser_->EnableTelemetryPolling( telemetryPoller_ );
+        telemetryPoller_->Start();
+    }
+
+    if ( !isBackgroundInitializationEnabled_ ) {
+        laser_->PrefetchValues();
+    }
+
     for ( Laser::PropertyIterator it = laser_->GetPropertyIteratorBegin(); it != laser_->GetPropertyIteratorEnd(); it++ ) {
 
-        ExposeToGui( it->second );
+        // In background initialization the properties start out with a placeholder valid for their type,
+        // and are filled in by the hydration thread:
+        if ( isBackgroundInitializationEnabled_ ) {
+            ExposeToGui( it->second, ( it->second->GetStereotype() == Property::String ? "" : "0" ) );
+        } else {
+            ExposeToGui( it->second, it->second->GetValue() );
+        }
+
         it->second->IntroduceToGuiEnvironment( this );
     }
 
+    CreateStatisticsProperties();
+
+    if ( isBackgroundInitializationEnabled_ ) {
+
+        isHydrationStopRequested_ = false;
+        isHydrating_ = true;
+        hydrationThread_ = std::thread( &CoboltOfficial::HydrateGuiProperties, this );
+
+    } else if ( warmStartDriver_ != NULL ) {
+        
+        warmStartDriver_->Save();
+    }
+
     isInitialized_ = true;
 
-    cobolt::Logger::Instance()->LogMessage( "CoboltOfficial::Initialize(): Initialization successful", true );
+    COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::Initialize(): Initialization successful" );
 
     return cobolt::return_code::ok;
 }
@@ -172,12 +369,30 @@ int CoboltOfficial::Shutdown()
         isInitialized_ = false;
     }
 
+    TearDown();
+
     return cobolt::return_code::ok;
 }
 
+/**
+ * \brief Fetches all laser property values in one batch before the properties are read one by one.
+ */
+int CoboltOfficial::UpdateStatus()
+{
+    {
+        std::shared_lock<std::shared_timed_mutex> lock( laserLifetimeMutex_ );
+
+        if ( laser_ != NULL ) {
+            laser_->PrefetchValues();
+        }
+    }
+
+    return CShutterBase<CoboltOfficial>::UpdateStatus();
+}
+
 bool CoboltOfficial::Busy()
 {
-    return isBusy_;
+    return ( isBusy_ || isHydrating_ );
 }
 
 void CoboltOfficial::GetName( char* name ) const
@@ -187,7 +402,9 @@ void CoboltOfficial::GetName( char* name ) const
 
 int CoboltOfficial::SetOpen( bool open )
 {
-    if ( !laser_->IsShutterEnabled() ) {
+    std::shared_lock<std::shared_timed_mutex> lock( laserLifetimeMutex_ );
+
+    if ( laser_ == NULL || !laser_->IsShutterEnabled() ) {
         return cobolt::return_code::laser_startup_incomplete;
     }
     
@@ -201,7 +418,9 @@ int CoboltOfficial::SetOpen( bool open )
  */
 int CoboltOfficial::GetOpen( bool& open )
 {
-    open = ( laser_->IsShutterEnabled() && laser_->IsShutterOpen() );
+    std::shared_lock<std::shared_timed_mutex> lock( laserLifetimeMutex_ );
+
+    open = ( laser_ != NULL && laser_->IsShutterEnabled() && laser_->IsShutterOpen() );
 
     return cobolt::return_code::ok;
 }
@@ -227,67 +446,232 @@ int CoboltOfficial::Fire( double deltaT )
  * \brief Adds some Cobolt laser serial communication handling on top of the Micro-manager
  *        serial communication class' handling.
  *
- * Sends the command, fetches the laser response and detects unsupported laser commands.
+ * Sends the command, fetches the laser response and detects unsupported laser commands. Holds the
+ * port lock throughout, so that no other command gets between a command and its response.
  */
 int CoboltOfficial::SendCommand( const std::string& command, std::string* response )
 {
-    Logger::Instance()->LogMessage( "CoboltOfficial::SendCommand: About to send command '" + command + "', response expected=" + ( response != NULL ? "yes" : "no" ), true );
+    // No port to talk to before Initialize() has selected one (e.g. in replay mode):
+    if ( portMutex_ == NULL ) {
+
+        logger_.LogError( "CoboltOfficial::SendCommand: No serial port to send '" + command + "' to" );
+        return cobolt::return_code::serial_port_undefined;
+    }
+
+    std::lock_guard<std::mutex> lock( *portMutex_ );
+
+    COBOLT_LOG_DEBUG( &logger_, logLineBuffer_.assign( "CoboltOfficial::SendCommand: About to send command '" )
+        .append( command ).append( "', response expected=" ).append( response != NULL ? "yes" : "no" ) );
+
+    if ( !traceRecorder_.IsOpen() ) {
+        return ExchangeCommand( command, response );
+    }
+
+    const TraceRecorder::clock_t::time_point start = TraceRecorder::clock_t::now();
+    const int returnCode = ExchangeCommand( command, response );
+    traceRecorder_.Record( start, command, returnCode, response );
+
+    return returnCode;
+}
 
+/**
+ * \brief The part of SendCommand() done with the port lock held.
+ */
+int CoboltOfficial::ExchangeCommand( const std::string& command, std::string* response )
+{
     // Split up into atomic commands if command is composite:
     if ( command.find( '\r' ) != std::string::npos ) {
 
-        std::string atomicCommand;
-
-        for ( int i = 0; i < command.length(); i++ ) {
+        size_t atomicCommandBegin = 0;
 
-            if ( command[ i ] == '\r' ) {
+        for ( size_t atomicCommandEnd = command.find( '\r' );
+              atomicCommandEnd != std::string::npos;
+              atomicCommandEnd = command.find( '\r', atomicCommandBegin ) ) {
 
-                int returnCode = SendCommand( atomicCommand );
+            atomicCommandBuffer_.assign( command, atomicCommandBegin, atomicCommandEnd - atomicCommandBegin );
+            atomicCommandBegin = atomicCommandEnd + 1;
 
-                if ( returnCode != return_code::ok ) {
-                    return returnCode;
-                }
+            const int returnCode = SendAtomicCommand( atomicCommandBuffer_, false );
 
-                atomicCommand.clear();
-                continue;
+            if ( returnCode != return_code::ok ) {
+                return returnCode;
             }
-
-            atomicCommand.push_back( command[ i ] );
         }
 
         return return_code::ok;
     }
 
+    const int returnCode = SendAtomicCommand( command, ( response != NULL ) );
+
+    // Error replies are handed over too, as they tell what the laser did not accept:
+    if ( response != NULL && ( returnCode == return_code::ok || returnCode == return_code::unsupported_command ) ) {
+        response->assign( replyBuffer_ ); // Copies into the capacity of the caller's string.
+    }
+
+    return returnCode;
+}
+
+/**
+ * \brief Sends a single command, leaving the reply in replyBuffer_ where it stays valid until the next
+ *        command is sent. All buffers are reused between calls, so a poll does not allocate once their
+ *        capacity has settled.
+ */
+int CoboltOfficial::SendAtomicCommand( const std::string& command, const bool isReplyWanted )
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
     int returnCode = SendSerialCommand( port_.c_str(), command.c_str(), "\r" );
     
-    if ( returnCode == cobolt::return_code::ok && response != NULL ) {
+    if ( returnCode == cobolt::return_code::ok && isReplyWanted ) {
 
-        returnCode = GetSerialAnswer( port_.c_str(), "\r\n", *response );
+        returnCode = GetSerialAnswer( port_.c_str(), "\r\n", replyBuffer_ );
         
         if ( returnCode != cobolt::return_code::ok ) {
 
-            Logger::Instance()->LogMessage( "CoboltOfficial::SendCommand: GetSerialAnswer Failed: " + std::to_string( (_Longlong) returnCode ), true );
+            COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::SendCommand: GetSerialAnswer Failed: " + std::to_string( (long long) returnCode ) );
+            replyBuffer_.clear();
 
-        } else if ( response->find( "error" ) != std::string::npos ||
-                    response->find( "Error" ) != std::string::npos ||
-                    response->find( "ERROR" ) != std::string::npos ) {
+        } else if ( IsErrorResponse( replyBuffer_ ) ) {
 
-            Logger::Instance()->LogMessage( "CoboltOfficial::SendCommand: Sent: " + command + " Reply received: " + *response, true );
+            COBOLT_LOG_DEBUG( &logger_, logLineBuffer_.assign( "CoboltOfficial::SendCommand: Sent: " ).append( command ).append( " Reply received: " ).append( replyBuffer_ ) );
             returnCode = cobolt::return_code::unsupported_command;
         }
     } else {
 
         // Flush the response (failing to do so will result in this response being provided as the response of the next command):
-        std::string ignoredResponse;
-        GetSerialAnswer( port_.c_str(), "\r\n", ignoredResponse );
+        GetSerialAnswer( port_.c_str(), "\r\n", replyBuffer_ );
+        replyBuffer_.clear();
         
         if ( returnCode != cobolt::return_code::ok ) {
-            Logger::Instance()->LogMessage( "CoboltOfficial::SendCommand: SendSerialCommand Failed: " + std::to_string( (_Longlong) returnCode ), true );
+            COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::SendCommand: SendSerialCommand Failed: " + std::to_string( (long long) returnCode ) );
         }
     }
+
+    commandStatistics_.Record( command, GetMicrosecondsSince( start ), ResolveCommandOutcome( returnCode ) );
+
     return returnCode;
 }
 
+/**
+ * \brief Pipelined version of SendCommand(): writes up to g_MaxPipelineDepth commands back to back
+ *        before collecting their replies, so that a batch costs about one round trip instead of one
+ *        round trip per command.
+ *
+ * The laser answers every command with exactly one '\r\n' terminated line, which lets us pair the
+ * replies with the commands in send order.
+ */
+int CoboltOfficial::SendCommandBatch( command_batch_t& batch )
+{
+    for ( command_batch_t::const_iterator entry = batch.begin(); entry != batch.end(); entry++ ) {
+
+        // Composite commands produce several replies each, fall back to sending one at a time:
+        if ( entry->command.find( '\r' ) != std::string::npos ) {
+            return LaserDriver::SendCommandBatch( batch );
+        }
+    }
+
+    if ( portMutex_ == NULL ) {
+
+        logger_.LogError( "CoboltOfficial::SendCommandBatch: No serial port to send the batch to" );
+
+        for ( command_batch_t::iterator entry = batch.begin(); entry != batch.end(); entry++ ) {
+
+            entry->response.clear();
+            entry->returnCode = cobolt::return_code::serial_port_undefined;
+        }
+
+        return cobolt::return_code::serial_port_undefined;
+    }
+
+    std::lock_guard<std::mutex> lock( *portMutex_ );
+
+    COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::SendCommandBatch: About to send batch of " + std::to_string( (long long) batch.size() ) + " commands" );
+
+    int batchReturnCode = return_code::ok;
+
+    for ( size_t first = 0; first < batch.size(); first += g_MaxPipelineDepth ) {
+
+        const size_t end = std::min( batch.size(), first + g_MaxPipelineDepth );
+        size_t sent = first;
+
+        TraceRecorder::clock_t::time_point sendTimes[ g_MaxPipelineDepth ];
+
+        for ( ; sent < end; sent++ ) {
+
+            sendTimes[ sent - first ] = TraceRecorder::clock_t::now();
+            batch[ sent ].response.clear();
+            batch[ sent ].returnCode = SendSerialCommand( port_.c_str(), batch[ sent ].command.c_str(), "\r" );
+
+            if ( batch[ sent ].returnCode != return_code::ok ) {
+
+                COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::SendCommandBatch: SendSerialCommand Failed: " + std::to_string( (long long) batch[ sent ].returnCode ) );
+                break;
+            }
+        }
+
+        const bool isPortFailing = ( sent < end );
+
+        if ( isPortFailing ) {
+
+            // Do not keep writing to a port that refused the previous command:
+            for ( size_t i = sent + 1; i < batch.size(); i++ ) {
+
+                batch[ i ].response.clear();
+                batch[ i ].returnCode = return_code::error;
+            }
+        }
+
+        bool isReplyStreamIntact = true;
+
+        for ( size_t i = first; i < sent; i++ ) {
+
+            BatchedCommand& entry = batch[ i ];
+
+            if ( !isReplyStreamIntact ) {
+
+                entry.returnCode = return_code::error;
+                continue;
+            }
+
+            entry.returnCode = GetSerialAnswer( port_.c_str(), "\r\n", entry.response );
+
+            if ( entry.returnCode != return_code::ok ) {
+
+                COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::SendCommandBatch: GetSerialAnswer Failed: " + std::to_string( (long long) entry.returnCode ) );
+
+                // A missing reply leaves us unable to tell which command any late reply belongs to:
+                PurgeComPort( port_.c_str() );
+                isReplyStreamIntact = false;
+
+            } else if ( IsErrorResponse( entry.response ) ) {
+
+                COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::SendCommandBatch: Sent: " + entry.command + " Reply received: " + entry.response );
+                entry.returnCode = return_code::unsupported_command;
+            }
+
+            // Measured from when the command was written, thus including the wait behind the replies before it:
+            commandStatistics_.Record( entry.command, GetMicrosecondsSince( sendTimes[ i - first ] ), ResolveCommandOutcome( entry.returnCode ) );
+
+            if ( traceRecorder_.IsOpen() ) {
+                traceRecorder_.Record( sendTimes[ i - first ], entry.command, entry.returnCode, &entry.response );
+            }
+        }
+
+        for ( size_t i = first; i < end; i++ ) {
+
+            if ( batch[ i ].returnCode != return_code::ok && batchReturnCode == return_code::ok ) {
+                batchReturnCode = batch[ i ].returnCode;
+            }
+        }
+
+        if ( isPortFailing ) {
+            break;
+        }
+    }
+
+    return batchReturnCode;
+}
+
 void CoboltOfficial::SendLogMessage( const char* message, bool debug ) const
 {
     LogMessage( message, debug );
@@ -303,6 +687,11 @@ int CoboltOfficial::RegisterAllowedGuiPropertyRange( const std::string& property
     return SetPropertyLimits( propertyName.c_str(), min, max );
 }
 
+void CoboltOfficial::NotifyGuiPropertyChanged( const std::string& propertyName, const std::string& value )
+{
+    OnPropertyChanged( propertyName.c_str(), value.c_str() );
+}
+
 int CoboltOfficial::OnPropertyAction_Port( MM::PropertyBase* mm_property, MM::ActionType action )
 {
     if ( action == MM::BeforeGet ) {
@@ -325,10 +714,245 @@ int CoboltOfficial::OnPropertyAction_Port( MM::PropertyBase* mm_property, MM::Ac
     return cobolt::return_code::ok;
 }
 
+int CoboltOfficial::OnPropertyAction_TelemetryPollInterval( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action == MM::BeforeGet ) {
+
+        mm_property->Set( telemetryPollIntervalMs_ );
+
+    } else if ( action == MM::AfterSet ) {
+
+        if ( isInitialized_ ) {
+            
+            // The poller is set up on initialization, thus reset value:
+            mm_property->Set( telemetryPollIntervalMs_ );
+            
+            return cobolt::return_code::property_not_settable_in_current_state;
+        }
+
+        mm_property->Get( telemetryPollIntervalMs_ );
+    }
+
+    return cobolt::return_code::ok;
+}
+
+int CoboltOfficial::OnPropertyAction_WarmStartCacheFile( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action == MM::BeforeGet ) {
+
+        mm_property->Set( warmStartCacheFile_.c_str() );
+
+    } else if ( action == MM::AfterSet ) {
+
+        if ( isInitialized_ ) {
+            
+            // The cache is only consulted on initialization, thus reset value:
+            mm_property->Set( warmStartCacheFile_.c_str() );
+            
+            return cobolt::return_code::property_not_settable_in_current_state;
+        }
+
+        mm_property->Get( warmStartCacheFile_ );
+    }
+
+    return cobolt::return_code::ok;
+}
+
+int CoboltOfficial::OnPropertyAction_BackgroundInitialization( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action == MM::BeforeGet ) {
+
+        mm_property->Set( isBackgroundInitializationEnabled_ ? g_Property_BackgroundInitialization_On : g_Property_BackgroundInitialization_Off );
+
+    } else if ( action == MM::AfterSet ) {
+
+        if ( isInitialized_ ) {
+            
+            // Only applies to initialization, thus reset value:
+            mm_property->Set( isBackgroundInitializationEnabled_ ? g_Property_BackgroundInitialization_On : g_Property_BackgroundInitialization_Off );
+            
+            return cobolt::return_code::property_not_settable_in_current_state;
+        }
+
+        std::string value;
+        mm_property->Get( value );
+        isBackgroundInitializationEnabled_ = ( value == g_Property_BackgroundInitialization_On );
+    }
+
+    return cobolt::return_code::ok;
+}
+
+int CoboltOfficial::OnPropertyAction_SetpointWriteBehind( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action == MM::BeforeGet ) {
+
+        mm_property->Set( isSetpointWriteBehindEnabled_ ? g_Property_SetpointWriteBehind_On : g_Property_SetpointWriteBehind_Off );
+
+    } else if ( action == MM::AfterSet ) {
+
+        if ( isInitialized_ ) {
+            
+            // Only applies to initialization, thus reset value:
+            mm_property->Set( isSetpointWriteBehindEnabled_ ? g_Property_SetpointWriteBehind_On : g_Property_SetpointWriteBehind_Off );
+            
+            return cobolt::return_code::property_not_settable_in_current_state;
+        }
+
+        std::string value;
+        mm_property->Get( value );
+        isSetpointWriteBehindEnabled_ = ( value == g_Property_SetpointWriteBehind_On );
+    }
+
+    return cobolt::return_code::ok;
+}
+
+int CoboltOfficial::OnPropertyAction_DebugLogging( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action == MM::BeforeGet ) {
+
+        mm_property->Set( logger_.IsDebugEnabled() ? g_Property_DebugLogging_On : g_Property_DebugLogging_Off );
+
+    } else if ( action == MM::AfterSet ) {
+
+        std::string value;
+        mm_property->Get( value );
+        logger_.SetDebugEnabled( value == g_Property_DebugLogging_On );
+    }
+
+    return cobolt::return_code::ok;
+}
+
+int CoboltOfficial::OnPropertyAction_TraceFile( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action == MM::BeforeGet ) {
+
+        mm_property->Set( traceFile_.c_str() );
+
+    } else if ( action == MM::AfterSet ) {
+
+        if ( isInitialized_ ) {
+            
+            // Recording starts on initialization, thus reset value:
+            mm_property->Set( traceFile_.c_str() );
+            
+            return cobolt::return_code::property_not_settable_in_current_state;
+        }
+
+        mm_property->Get( traceFile_ );
+    }
+
+    return cobolt::return_code::ok;
+}
+
+int CoboltOfficial::OnPropertyAction_ReplayTraceFile( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action == MM::BeforeGet ) {
+
+        mm_property->Set( replayTraceFile_.c_str() );
+
+    } else if ( action == MM::AfterSet ) {
+
+        if ( isInitialized_ ) {
+            
+            // The wire driver is chosen on initialization, thus reset value:
+            mm_property->Set( replayTraceFile_.c_str() );
+            
+            return cobolt::return_code::property_not_settable_in_current_state;
+        }
+
+        mm_property->Get( replayTraceFile_ );
+    }
+
+    return cobolt::return_code::ok;
+}
+
+int CoboltOfficial::OnPropertyAction_ReplayTiming( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action == MM::BeforeGet ) {
+
+        mm_property->Set( isReplayTimingCompressed_ ? g_Property_ReplayTiming_Compressed : g_Property_ReplayTiming_Original );
+
+    } else if ( action == MM::AfterSet ) {
+
+        if ( isInitialized_ ) {
+            
+            // Only applies to initialization, thus reset value:
+            mm_property->Set( isReplayTimingCompressed_ ? g_Property_ReplayTiming_Compressed : g_Property_ReplayTiming_Original );
+            
+            return cobolt::return_code::property_not_settable_in_current_state;
+        }
+
+        std::string value;
+        mm_property->Get( value );
+        isReplayTimingCompressed_ = ( value == g_Property_ReplayTiming_Compressed );
+    }
+
+    return cobolt::return_code::ok;
+}
+
+int CoboltOfficial::OnPropertyAction_Statistics( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action != MM::BeforeGet ) {
+        return cobolt::return_code::ok;
+    }
+
+    const std::string name = mm_property->GetName();
+
+    if ( name == g_Property_Statistics_BusiestCommands ) {
+
+        mm_property->Set( commandStatistics_.GetBusiestOpcodes( 5 ).c_str() );
+        return cobolt::return_code::ok;
+    }
+
+    const CommandStatistics::Summary total = commandStatistics_.GetTotal();
+
+    if ( name == g_Property_Statistics_Commands ) {
+        mm_property->Set( (long) total.count );
+    } else if ( name == g_Property_Statistics_Errors ) {
+        mm_property->Set( (long) total.errorCount );
+    } else if ( name == g_Property_Statistics_Timeouts ) {
+        mm_property->Set( (long) total.timeoutCount );
+    } else if ( name == g_Property_Statistics_LatencyP50 ) {
+        mm_property->Set( total.p50Us );
+    } else if ( name == g_Property_Statistics_LatencyP95 ) {
+        mm_property->Set( total.p95Us );
+    } else if ( name == g_Property_Statistics_LatencyP99 ) {
+        mm_property->Set( total.p99Us );
+    } else if ( name == g_Property_Statistics_LatencyMax ) {
+        mm_property->Set( total.maxUs );
+    }
+
+    return cobolt::return_code::ok;
+}
+
+int CoboltOfficial::OnPropertyAction_StatisticsDumpFile( MM::PropertyBase* mm_property, MM::ActionType action )
+{
+    if ( action == MM::AfterSet ) {
+
+        std::string filePath;
+        mm_property->Get( filePath );
+
+        if ( filePath.length() > 0 && commandStatistics_.Dump( filePath ) != cobolt::return_code::ok ) {
+
+            logger_.LogError( "CoboltOfficial::OnPropertyAction_StatisticsDumpFile(): Failed to write statistics to '" + filePath + "'" );
+            return cobolt::return_code::error;
+        }
+    }
+
+    return cobolt::return_code::ok;
+}
+
 int CoboltOfficial::OnPropertyAction_Laser( MM::PropertyBase* mm_property, MM::ActionType action )
 {
     GuiPropertyAdapter guiProperty( mm_property );
 
+    std::shared_lock<std::shared_timed_mutex> lock( laserLifetimeMutex_ );
+
+    // The GUI keeps the laser properties after Shutdown():
+    if ( laser_ == NULL ) {
+        return return_code::laser_startup_incomplete;
+    }
+
     int returnCode = return_code::ok;
     Property* property = laser_->GetProperty( mm_property->GetName() );
     
@@ -356,10 +980,32 @@ MM::PropertyType CoboltOfficial::ResolvePropertyType( const cobolt::Property::St
     return MM::Undef;
 }
 
-int CoboltOfficial::ExposeToGui( const Property* property )
+/**
+ * \brief Exposes the command counts and latencies of the serial traffic, to see which properties and
+ *        panels load the port. Setting the dump property writes the statistics per command to a file.
+ */
+void CoboltOfficial::CreateStatisticsProperties()
 {
-    const std::string initialValue = property->GetValue();
+    const char* const integerProperties[] = {
+        g_Property_Statistics_Commands,
+        g_Property_Statistics_Errors,
+        g_Property_Statistics_Timeouts,
+        g_Property_Statistics_LatencyP50,
+        g_Property_Statistics_LatencyP95,
+        g_Property_Statistics_LatencyP99,
+        g_Property_Statistics_LatencyMax
+    };
+
+    for ( size_t i = 0; i < sizeof( integerProperties ) / sizeof( integerProperties[ 0 ] ); i++ ) {
+        CreateProperty( integerProperties[ i ], "0", MM::Integer, true, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_Statistics ) );
+    }
+
+    CreateProperty( g_Property_Statistics_BusiestCommands, "", MM::String, true, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_Statistics ) );
+    CreateProperty( g_Property_Statistics_DumpFile, "", MM::String, false, new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_StatisticsDumpFile ) );
+}
 
+int CoboltOfficial::ExposeToGui( const Property* property, const std::string& initialValue )
+{
     CPropertyAction* action = new CPropertyAction( this, &CoboltOfficial::OnPropertyAction_Laser );
     const int returnCode = CreateProperty(
         property->GetName().c_str(),
@@ -369,10 +1015,85 @@ int CoboltOfficial::ExposeToGui( const Property* property )
         action );
     
     if ( returnCode != return_code::ok ) {
-        Logger::Instance()->LogMessage( "CoboltOfficial::ExposeToGui( '" + property->GetName() + "' ): Failed to expose property { " + property->ObjectString() + " } to GUI.", true );
+        COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::ExposeToGui( '" + property->GetName() + "' ): Failed to expose property { " + property->ObjectString() + " } to GUI." );
     } else {
-        Logger::Instance()->LogMessage( "CoboltOfficial::ExposeToGui( '" + property->GetName() + "' ): Exposed property { " + property->ObjectString() + " } to GUI with initial value = '" + initialValue + "'.", true );
+        COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::ExposeToGui( '" + property->GetName() + "' ): Exposed property { " + property->ObjectString() + " } to GUI with initial value = '" + initialValue + "'." );
     }
 
     return returnCode;
 }
+
+void CoboltOfficial::HydrateGuiProperties()
+{
+    // No lock on the laser needed, as TearDown() joins this thread before deleting it:
+    laser_->PrefetchValues();
+
+    for ( Laser::PropertyIterator it = laser_->GetPropertyIteratorBegin();
+          it != laser_->GetPropertyIteratorEnd() && !isHydrationStopRequested_;
+          it++ ) {
+
+        const std::string value = it->second->GetValue();
+        OnPropertyChanged( it->second->GetName().c_str(), value.c_str() );
+    }
+
+    if ( warmStartDriver_ != NULL ) {
+        warmStartDriver_->Save();
+    }
+
+    isHydrating_ = false;
+
+    COBOLT_LOG_DEBUG( &logger_, "CoboltOfficial::HydrateGuiProperties(): Background initialization completed" );
+}
+
+void CoboltOfficial::StopHydration()
+{
+    isHydrationStopRequested_ = true;
+
+    if ( hydrationThread_.joinable() ) {
+        hydrationThread_.join();
+    }
+
+    isHydrating_ = false;
+}
+
+void CoboltOfficial::TearDown()
+{
+    StopHydration();
+
+    if ( telemetryPoller_ != NULL ) {
+        telemetryPoller_->Stop();
+    }
+
+    // Complete any outstanding commands before the properties waiting for them are deleted:
+    if ( laserDriver_ != NULL ) {
+        laserDriver_->Stop();
+    }
+
+    {
+        // Waits for the callers still using the laser, and keeps new ones out until it is gone:
+        std::lock_guard<std::shared_timed_mutex> lock( laserLifetimeMutex_ );
+
+        if ( laser_ != NULL ) {
+            delete laser_;
+            laser_ = NULL;
+        }
+    }
+
+    if ( telemetryPoller_ != NULL ) {
+        delete telemetryPoller_;
+        telemetryPoller_ = NULL;
+    }
+
+    if ( warmStartDriver_ != NULL ) {
+        delete warmStartDriver_;
+        warmStartDriver_ = NULL;
+    }
+
+    // A stopped driver takes no more commands, the next initialization starts a new one:
+    if ( laserDriver_ != NULL ) {
+        delete laserDriver_;
+        laserDriver_ = NULL;
+    }
+
+    traceRecorder_.Close();
+}
@@ -38,10 +38,21 @@
 #define __COBOLT_OFFICIAL_H
 
 #include "DeviceBase.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include "LaserFactory.h"
 #include "Logger.h"
+#include "AsyncLogGateway.h"
+#include "CommandStatistics.h"
+#include "ReplayLaserDriver.h"
+#include "TraceRecorder.h"
 #include "LaserDriver.h"
+#include "AsyncLaserDriver.h"
+#include "TelemetryPoller.h"
+#include "WarmStartLaserDriver.h"
 
 class CoboltOfficial : 
     public CShutterBase<CoboltOfficial>, 
@@ -59,6 +70,7 @@ public:
     
     int Initialize();
     int Shutdown();
+    int UpdateStatus();
     bool Busy();
     void GetName( char* name ) const;
 
@@ -75,9 +87,10 @@ public:
     int Fire( double duration );
 
     /// ###
-    /// LaserDriver API
+    /// LaserDriver API (wire level, used by the I/O thread of laserDriver_, safe to call from any thread)
 
     virtual int SendCommand( const std::string& command, std::string* response = NULL );
+    virtual int SendCommandBatch( command_batch_t& batch );
 
     /// ###
     /// LoggerGateway API
@@ -89,23 +102,81 @@ public:
 
     virtual int RegisterAllowedGuiPropertyValue( const std::string& propertyName, const std::string& value );
     virtual int RegisterAllowedGuiPropertyRange( const std::string& propertyName, double min, double max );
+    virtual void NotifyGuiPropertyChanged( const std::string& propertyName, const std::string& value );
 
     /// ###
     /// Property Action Handlers
 
     int OnPropertyAction_Port( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_TelemetryPollInterval( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_WarmStartCacheFile( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_BackgroundInitialization( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_SetpointWriteBehind( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_DebugLogging( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_TraceFile( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_ReplayTraceFile( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_ReplayTiming( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_Statistics( MM::PropertyBase*, MM::ActionType );
+    int OnPropertyAction_StatisticsDumpFile( MM::PropertyBase*, MM::ActionType );
     int OnPropertyAction_Laser( MM::PropertyBase*, MM::ActionType );
 
 private:
 
+    int ExchangeCommand( const std::string& command, std::string* response );
+    int SendAtomicCommand( const std::string& command, bool isReplyWanted );
+
+    void CreateStatisticsProperties();
+
     MM::PropertyType ResolvePropertyType( const cobolt::Property::Stereotype ) const;
-    int ExposeToGui( const cobolt::Property* property );
+    int ExposeToGui( const cobolt::Property* property, const std::string& initialValue );
+
+    /**
+     * \brief Reads the initial values of the laser properties and hands them to the GUI, run by the
+     *        hydration thread when background initialization is enabled.
+     */
+    void HydrateGuiProperties();
+    void StopHydration();
+
+    /**
+     * \brief Stops the threads working on the laser, and deletes the laser and its drivers so that
+     *        the adapter can be initialized again.
+     */
+    void TearDown();
     
+    cobolt::Logger logger_;
+    cobolt::AsyncLogGateway* logGateway_;
+    cobolt::AsyncLaserDriver* laserDriver_;
+    cobolt::WarmStartLaserDriver* warmStartDriver_;
+    cobolt::ReplayLaserDriver* replayDriver_;
     cobolt::Laser* laser_;
+    cobolt::TelemetryPoller* telemetryPoller_;
 
     bool isInitialized_;
     bool isBusy_;
     std::string port_;
+    std::mutex* portMutex_;
+    cobolt::CommandStatistics commandStatistics_;
+    cobolt::TraceRecorder traceRecorder_;
+    long telemetryPollIntervalMs_;
+    std::string warmStartCacheFile_;
+    std::string traceFile_;
+    std::string replayTraceFile_;
+    bool isReplayTimingCompressed_;
+    bool isBackgroundInitializationEnabled_;
+    bool isSetpointWriteBehindEnabled_;
+
+    /// Wire level buffers, guarded by the port lock and reused between commands:
+    std::string atomicCommandBuffer_;
+    std::string replyBuffer_;
+    std::string logLineBuffer_;
+
+    /// Guards the lifetime of laser_: its users hold it shared, so they never wait for each other's
+    /// serial exchanges, and only TearDown() takes it exclusively, to delete the laser:
+    std::shared_timed_mutex laserLifetimeMutex_;
+
+    std::thread hydrationThread_;
+    std::atomic<bool> isHydrating_;
+    std::atomic<bool> isHydrationStopRequested_;
 };
 
 #endif // #ifndef __COBOLT_OFFICIAL_H
\ No newline at end of file
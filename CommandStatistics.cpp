@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       CommandStatistics.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include "CommandStatistics.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+std::string CommandStatistics::GetOpcode( const std::string& command )
+{
+    size_t begin = 0;
+
+    while ( begin < command.length() && command[ begin ] >= '0' && command[ begin ] <= '9' ) {
+        begin++;
+    }
+
+    // Bare numbers (e.g. the device mode command) are opcodes of their own:
+    if ( begin == command.length() ) {
+        begin = 0;
+    }
+
+    const size_t end = command.find( ' ', begin );
+
+    return command.substr( begin, ( end == std::string::npos ? std::string::npos : end - begin ) );
+}
+
+CommandStatistics::Outcome CommandStatistics::ResolveOutcome( const int returnCode )
+{
+    if ( returnCode == return_code::ok ) {
+        return Ok;
+    }
+
+    if ( returnCode == return_code::serial_port_timeout || returnCode == return_code::serial_manager_timeout ) {
+        return Timeout;
+    }
+
+    return Error;
+}
+
+void CommandStatistics::Record( const std::string& command, const long latencyUs, const Outcome outcome )
+{
+    const std::string opcode = GetOpcode( command );
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    total_.Add( latencyUs, outcome );
+    entries_[ opcode ].Add( latencyUs, outcome );
+}
+
+CommandStatistics::Summary CommandStatistics::GetTotal() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return total_.Summarize();
+}
+
+std::string CommandStatistics::GetBusiestOpcodes( const size_t maxCount ) const
+{
+    std::vector< std::pair<unsigned long, std::string> > counts;
+
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+
+        for ( entries_t::const_iterator entry = entries_.begin(); entry != entries_.end(); entry++ ) {
+            counts.push_back( std::make_pair( entry->second.count, entry->first ) );
+        }
+    }
+
+    std::sort( counts.rbegin(), counts.rend() );
+
+    std::string busiestOpcodes;
+
+    for ( size_t i = 0; i < counts.size() && i < maxCount; i++ ) {
+
+        if ( i > 0 ) {
+            busiestOpcodes += " ";
+        }
+
+        busiestOpcodes += counts[ i ].second + ":" + std::to_string( (unsigned long long) counts[ i ].first );
+    }
+
+    return busiestOpcodes;
+}
+
+int CommandStatistics::Dump( const std::string& filePath ) const
+{
+    std::ofstream file( filePath.c_str(), std::ios::out | std::ios::trunc );
+
+    if ( !file.is_open() ) {
+        return return_code::error;
+    }
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    file << "opcode\tcount\terrors\ttimeouts\tp50 [us]\tp95 [us]\tp99 [us]\tmax [us]\n";
+
+    for ( entries_t::const_iterator entry = entries_.begin(); entry != entries_.end(); entry++ ) {
+
+        const Summary summary = entry->second.Summarize();
+
+        file << entry->first << "\t" << summary.count << "\t" << summary.errorCount << "\t" << summary.timeoutCount << "\t"
+             << summary.p50Us << "\t" << summary.p95Us << "\t" << summary.p99Us << "\t" << summary.maxUs << "\n";
+    }
+
+    return ( file.good() ? return_code::ok : return_code::error );
+}
+
+CommandStatistics::Entry::Entry() :
+    count( 0 ),
+    errorCount( 0 ),
+    timeoutCount( 0 ),
+    maxUs( 0 )
+{
+    std::fill( buckets, buckets + BucketCount, 0 );
+}
+
+void CommandStatistics::Entry::Add( const long latencyUs, const Outcome outcome )
+{
+    count++;
+
+    if ( outcome == Error ) {
+        errorCount++;
+    } else if ( outcome == Timeout ) {
+        timeoutCount++;
+    }
+
+    maxUs = std::max( maxUs, latencyUs );
+
+    // Bucket i holds latencies up to 2^i us:
+    int bucket = 0;
+    while ( bucket < BucketCount - 1 && ( 1L << bucket ) < latencyUs ) {
+        bucket++;
+    }
+
+    buckets[ bucket ]++;
+}
+
+CommandStatistics::Summary CommandStatistics::Entry::Summarize() const
+{
+    Summary summary;
+
+    summary.count = count;
+    summary.errorCount = errorCount;
+    summary.timeoutCount = timeoutCount;
+    summary.p50Us = GetPercentileUs( 50 );
+    summary.p95Us = GetPercentileUs( 95 );
+    summary.p99Us = GetPercentileUs( 99 );
+    summary.maxUs = maxUs;
+
+    return summary;
+}
+
+/**
+ * \brief The latency within which the given percentage of the commands completed, rounded up to the
+ *        bucket limit.
+ */
+long CommandStatistics::Entry::GetPercentileUs( const unsigned long percent ) const
+{
+    if ( count == 0 ) {
+        return 0;
+    }
+
+    const unsigned long rank = ( count * percent + 99 ) / 100;
+    unsigned long cumulativeCount = 0;
+
+    for ( int i = 0; i < BucketCount; i++ ) {
+
+        cumulativeCount += buckets[ i ];
+
+        if ( cumulativeCount >= rank ) {
+            return std::min( 1L << i, maxUs );
+        }
+    }
+
+    return maxUs;
+}
+
+NAMESPACE_COBOLT_END
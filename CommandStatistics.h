@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       CommandStatistics.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__COMMAND_STATISTICS_H
+#define __COBOLT__COMMAND_STATISTICS_H
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "base.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Counts and latency histograms of the commands sent to a laser, per opcode and in total. Safe
+ *        to use from several threads.
+ *
+ * Latencies are kept in power-of-two buckets of microseconds, so percentiles are reported as the
+ * upper bound of the bucket they fall into (at most twice the actual value). The max is exact.
+ */
+class CommandStatistics
+{
+public:
+
+    enum Outcome { Ok, Error, Timeout };
+
+    struct Summary
+    {
+        unsigned long count;
+        unsigned long errorCount;
+        unsigned long timeoutCount;
+        long p50Us;
+        long p95Us;
+        long p99Us;
+        long maxUs;
+    };
+
+    /**
+     * \brief The opcode of a command: the command without Skyra line prefix and arguments.
+     */
+    static std::string GetOpcode( const std::string& command );
+
+    /**
+     * \brief Classifies the return code of a command exchange. Timeouts of the POSIX driver and of
+     *        Micro-Manager's serial port count as timeouts, other failures as errors.
+     */
+    static Outcome ResolveOutcome( const int returnCode );
+
+    void Record( const std::string& command, const long latencyUs, const Outcome outcome );
+
+    Summary GetTotal() const;
+
+    /**
+     * \brief The opcodes sent most often, as "opcode:count" separated by spaces.
+     */
+    std::string GetBusiestOpcodes( const size_t maxCount ) const;
+
+    /**
+     * \brief Writes a tab separated table of the statistics per opcode to the file.
+     */
+    int Dump( const std::string& filePath ) const;
+
+private:
+
+    static const int BucketCount = 31; // Up to 2^30 us, about 18 minutes.
+
+    struct Entry
+    {
+        Entry();
+
+        void Add( const long latencyUs, const Outcome outcome );
+        Summary Summarize() const;
+        long GetPercentileUs( const unsigned long percent ) const;
+
+        unsigned long count;
+        unsigned long errorCount;
+        unsigned long timeoutCount;
+        long maxUs;
+        unsigned long buckets[ BucketCount ];
+    };
+
+    typedef std::map<std::string, Entry> entries_t;
+
+    mutable std::mutex mutex_;
+    Entry total_;
+    entries_t entries_;
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__COMMAND_STATISTICS_H
\ No newline at end of file
@@ -36,45 +36,163 @@
 
 #include "DeviceProperty.h"
 #include "Laser.h"
+#include "TelemetryPoller.h"
 
 NAMESPACE_COBOLT_BEGIN
 
+/**
+ * Time within which a prefetched reply must be consumed, after which the laser is queried again.
+ */
+const int g_PrefetchedReplyLifetimeMs = 1000;
+
 DeviceProperty::DeviceProperty( Property::Stereotype stereotype, const std::string& name, LaserDriver* laserDriver, const std::string& getCommand ) :
     Property( stereotype, name ),
     laserDriver_( laserDriver ),
     getCommand_( getCommand ),
-    doCache_( true )
+    timeToLiveMs_( CacheForever ),
+    staleWhileRevalidateMs_( 0 ),
+    cacheTime_( 0 ),
+    isRefreshPending_( false ),
+    isOversizedValueLogged_( false ),
+    hasPrefetchedReply_( false ),
+    prefetchedReply_( getCommand ),
+    telemetrySnapshot_( NULL ),
+    telemetrySnapshotVersion_( 0 )
 {}
 
 void DeviceProperty::SetCaching( const bool enabled )
 {
-    doCache_ = enabled;
+    if ( enabled ) {
+        SetCachePolicy( CacheForever );
+    } else {
+        SetCachePolicy( 0 );
+    }
+}
+
+void DeviceProperty::SetCachePolicy( const int timeToLiveMs, const int staleWhileRevalidateMs )
+{
+    timeToLiveMs_ = timeToLiveMs;
+    staleWhileRevalidateMs_ = staleWhileRevalidateMs;
+}
+
+void DeviceProperty::PollWith( TelemetryPoller* poller )
+{
+    telemetrySnapshot_ = poller->Subscribe( getCommand_ );
+}
+
+bool DeviceProperty::AppendPrefetchCommand( LaserDriver::command_batch_t& batch ) const
+{
+    const bool isQuery = ( getCommand_.length() > 0 && getCommand_[ getCommand_.length() - 1 ] == '?' );
+
+    if ( !isQuery ) {
+        return false;
+    }
+
+    if ( telemetrySnapshot_ != NULL && !telemetrySnapshot_->IsEmpty() ) {
+        return false;
+    }
+
+    if ( IsCacheEnabled() ) {
+
+        std::string cachedValue;
+        const CacheState cacheState = ReadCache( cachedValue );
+
+        if ( cacheState == Fresh || cacheState == Stale ) {
+            return false;
+        }
+    }
+
+    batch.push_back( LaserDriver::BatchedCommand( getCommand_ ) );
+
+    return true;
+}
+
+void DeviceProperty::SetPrefetchedReply( const LaserDriver::BatchedCommand& reply ) const
+{
+    std::lock_guard<std::mutex> lock( prefetchMutex_ );
+
+    hasPrefetchedReply_ = true;
+    prefetchedReply_ = reply;
+    prefetchTime_ = clock_t::now();
 }
 
 std::string DeviceProperty::ObjectString() const
 {
-    return Property::ObjectString() + "getCommand_ = " + getCommand_ + "; ";
+    return Property::ObjectString() + "getCommand_ = " + getCommand_ + "; timeToLiveMs_ = " + std::to_string( (long long) timeToLiveMs_.load() ) + "; ";
 }
 
 int DeviceProperty::GetValue( std::string& string ) const
+{
+    return GetDeviceValue( string, LaserDriver::Telemetry );
+}
+
+void DeviceProperty::OnCommandCompleted( const std::string& command, int returnCode, const std::string& response )
+{
+    if ( returnCode == return_code::ok ) {
+        OnDeviceValueReceived( response );
+        StoreInCache( response );
+    }
+
+    isRefreshPending_ = false;
+}
+
+/**
+ * \brief Retrieves the value like GetValue() does, but with the given priority in case the device has
+ *        to be queried.
+ */
+int DeviceProperty::GetDeviceValue( std::string& string, LaserDriver::Priority priority ) const
 {
     int returnCode = return_code::ok;
 
+    // Urgent requests (e.g. on the shutter path) must not settle for a value that may be one poll old:
+    if ( telemetrySnapshot_ != NULL && priority == LaserDriver::Telemetry ) {
+
+        unsigned version;
+
+        if ( telemetrySnapshot_->Read( returnCode, string, version ) ) {
+
+            if ( returnCode != return_code::ok ) {
+                SetToUnknownValue( string );
+            } else if ( telemetrySnapshotVersion_.exchange( version ) != version ) {
+                OnDeviceValueReceived( string ); // Once per poll, not once per read.
+            }
+
+            return returnCode;
+        }
+    }
+
     if ( IsCacheEnabled() ) {
 
-        if ( cachedValue_.length() == 0 ) {
-            returnCode = laserDriver_->SendCommand( getCommand_, &cachedValue_ );
+        const CacheState cacheState = ReadCache( string );
+        const bool isTimeLimited = ( timeToLiveMs_ != CacheForever );
+
+        // For the same reason as above, urgent requests only trust values that never expire:
+        const bool isCacheUsable = ( cacheState == Fresh || cacheState == Stale ) &&
+                                   ( priority != LaserDriver::Emission || !isTimeLimited );
+
+        if ( isCacheUsable && cacheState == Stale ) {
+            RequestRefresh();
         }
 
-        if ( returnCode == return_code::ok ) {
-            string = cachedValue_;
-        } else {
-            ClearCache();
+        if ( !isCacheUsable ) {
+
+            returnCode = QueryDevice( string, priority );
+
+            if ( returnCode == return_code::ok ) {
+                OnDeviceValueReceived( string );
+                StoreInCache( string );
+            } else {
+                ClearCache();
+            }
         }
 
     } else {
 
-        returnCode = laserDriver_->SendCommand( getCommand_, &string );
+        returnCode = QueryDevice( string, priority );
+
+        if ( returnCode == return_code::ok ) {
+            OnDeviceValueReceived( string );
+        }
     }
 
     if ( returnCode != return_code::ok ) {
@@ -84,19 +202,113 @@ int DeviceProperty::GetValue( std::string& string ) const
     return returnCode;
 }
 
+void DeviceProperty::OnDeviceValueReceived( const std::string& deviceValue ) const
+{}
+
 bool DeviceProperty::IsCacheEnabled() const
 {
-    return doCache_;
+    return ( timeToLiveMs_ != 0 );
 }
 
+/**
+ * \brief Forgets the cached value, including a prefetched reply that may predate a set.
+ */
 void DeviceProperty::ClearCache() const
 {
-    cachedValue_.clear();
+    cachedValue_.Write( return_code::ok, "" );
+
+    std::lock_guard<std::mutex> lock( prefetchMutex_ );
+    hasPrefetchedReply_ = false;
+}
+
+std::string DeviceProperty::GetCachedValue() const
+{
+    std::string value;
+    ReadCache( value );
+    return value;
 }
 
-const std::string& DeviceProperty::GetCachedValue() const
+/**
+ * \brief Queries the laser, unless a prefetched reply is waiting to be consumed.
+ */
+int DeviceProperty::QueryDevice( std::string& string, LaserDriver::Priority priority ) const
 {
-    return cachedValue_;
+    {
+        std::lock_guard<std::mutex> lock( prefetchMutex_ );
+
+        const bool isPrefetchedReplyUsable = ( hasPrefetchedReply_ && priority != LaserDriver::Emission &&
+            clock_t::now() - prefetchTime_ < std::chrono::milliseconds( g_PrefetchedReplyLifetimeMs ) );
+
+        hasPrefetchedReply_ = false;
+
+        if ( isPrefetchedReplyUsable ) {
+
+            string = prefetchedReply_.response;
+            return prefetchedReply_.returnCode;
+        }
+    }
+
+    return laserDriver_->SendCommand( getCommand_, &string, priority );
+}
+
+/**
+ * \brief Copies the cached value, without taking a lock.
+ */
+DeviceProperty::CacheState DeviceProperty::ReadCache( std::string& value ) const
+{
+    // Loaded before the value, so that a concurrent store can only make the value look older:
+    const clock_t::time_point cacheTime = clock_t::time_point( clock_t::duration( cacheTime_.load( std::memory_order_acquire ) ) );
+
+    int returnCode;
+
+    if ( !cachedValue_.Read( returnCode, value ) || value.length() == 0 ) {
+        value.clear();
+        return Missing;
+    }
+
+    const int timeToLiveMs = timeToLiveMs_;
+
+    if ( timeToLiveMs == CacheForever ) {
+        return Fresh;
+    }
+
+    const clock_t::duration age = clock_t::now() - cacheTime;
+
+    if ( age <= std::chrono::milliseconds( timeToLiveMs ) ) {
+        return Fresh;
+    }
+
+    if ( age <= std::chrono::milliseconds( timeToLiveMs + staleWhileRevalidateMs_ ) ) {
+        return Stale;
+    }
+
+    return Expired;
+}
+
+void DeviceProperty::StoreInCache( const std::string& value ) const
+{
+    if ( !cachedValue_.Write( return_code::ok, value ) ) {
+
+        // Such a value is queried again on every read, so only tell about it once:
+        if ( !isOversizedValueLogged_.exchange( true ) ) {
+            GetLogger()->LogError( "DeviceProperty[" + GetName() + "]::StoreInCache(): Value '" + value + "' too long for cache, it will not be cached" );
+        }
+
+        ClearCache();
+        return;
+    }
+
+    cacheTime_.store( clock_t::now().time_since_epoch().count(), std::memory_order_release );
+}
+
+/**
+ * \brief Asks for the stale cached value to be refreshed in the background, unless already asked.
+ */
+void DeviceProperty::RequestRefresh() const
+{
+    if ( !isRefreshPending_.exchange( true ) ) {
+        laserDriver_->SendCommandAsync( getCommand_, const_cast<DeviceProperty*>( this ), LaserDriver::Telemetry );
+    }
 }
 
 NAMESPACE_COBOLT_END
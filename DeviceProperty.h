@@ -37,16 +37,30 @@
 #ifndef __COBOLT__DEVICE_PROPERTY_H
 #define __COBOLT__DEVICE_PROPERTY_H
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
 #include "Property.h"
+#include "LaserDriver.h"
+#include "ValueSnapshot.h"
 
 NAMESPACE_COBOLT_BEGIN
 
-class LaserDriver;
+class TelemetryPoller;
 
-class DeviceProperty : public Property
+/**
+ * \brief A property read from the laser with a get command.
+ *
+ * Safe to use from several threads. The cached value lives in a ValueSnapshot together with an atomic
+ * timestamp, so cache hits are served without taking a lock.
+ */
+class DeviceProperty : public Property, public LaserDriver::Completion
 {
 public:
 
+    static const int CacheForever = -1;
+
     DeviceProperty( Property::Stereotype stereotype, const std::string& name, LaserDriver* laserDriver, const std::string& getCommand );
 
     /**
@@ -56,25 +70,88 @@ public:
      */
     void SetCaching( const bool enabled );
 
+    /**
+     * \brief Caches the value for timeToLiveMs (CacheForever: until changed on the Micromanager side,
+     *        0: no caching). A value that expired less than staleWhileRevalidateMs ago is still
+     *        returned, while a refresh is requested in the background.
+     */
+    void SetCachePolicy( const int timeToLiveMs, const int staleWhileRevalidateMs = 0 );
+
+    /**
+     * \brief Lets the poller keep this property's value up to date. GetValue() then returns the
+     *        latest polled value instead of querying the laser.
+     */
+    void PollWith( TelemetryPoller* poller );
+
+    /**
+     * \brief Adds the get command to the batch, unless the value would be served without querying
+     *        the laser anyway. Returns true if the command was added.
+     */
+    bool AppendPrefetchCommand( LaserDriver::command_batch_t& batch ) const;
+
+    /**
+     * \brief Makes the next GetValue() return the reply of a prefetch batch instead of querying the
+     *        laser, provided it follows shortly.
+     */
+    void SetPrefetchedReply( const LaserDriver::BatchedCommand& reply ) const;
+
     virtual std::string ObjectString() const;
 
     using Property::GetValue;
     virtual int GetValue( std::string& string ) const;
 
+    /// ###
+    /// LaserDriver::Completion API (background cache refresh)
+
+    virtual void OnCommandCompleted( const std::string& command, int returnCode, const std::string& response );
+
 protected:
 
+    int GetDeviceValue( std::string& string, LaserDriver::Priority priority ) const;
+
+    /**
+     * \brief Called with every value successfully read from the laser (not with cached values), and
+     *        with every new polled value, for subclasses that keep the laser's value in a native
+     *        type. Default does nothing.
+     */
+    virtual void OnDeviceValueReceived( const std::string& deviceValue ) const;
+
     virtual bool IsCacheEnabled() const;
     void ClearCache() const;
-    const std::string& GetCachedValue() const;
+    std::string GetCachedValue() const;
 
     LaserDriver* laserDriver_;
 
 private:
 
+    typedef std::chrono::steady_clock clock_t;
+
+    enum CacheState { Missing, Fresh, Stale, Expired };
+
+    CacheState ReadCache( std::string& value ) const;
+    void StoreInCache( const std::string& value ) const;
+    void RequestRefresh() const;
+
+    int QueryDevice( std::string& string, LaserDriver::Priority priority ) const;
+
     std::string getCommand_;
 
-    bool doCache_;
-    mutable std::string cachedValue_;
+    std::atomic<int> timeToLiveMs_;
+    std::atomic<int> staleWhileRevalidateMs_;
+
+    /// An empty cached value means nothing is cached:
+    mutable ValueSnapshot cachedValue_;
+    mutable std::atomic<clock_t::rep> cacheTime_;
+    mutable std::atomic<bool> isRefreshPending_;
+    mutable std::atomic<bool> isOversizedValueLogged_;
+
+    mutable std::mutex prefetchMutex_;
+    mutable bool hasPrefetchedReply_;
+    mutable LaserDriver::BatchedCommand prefetchedReply_;
+    mutable clock_t::time_point prefetchTime_;
+
+    const ValueSnapshot* telemetrySnapshot_;
+    mutable std::atomic<unsigned> telemetrySnapshotVersion_;
 };
 
 NAMESPACE_COBOLT_END
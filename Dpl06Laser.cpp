@@ -46,11 +46,13 @@
 using namespace std;
 using namespace cobolt;
 
-Dpl06Laser::Dpl06Laser( const std::string& wavelength, LaserDriver* driver ) :
-    Laser( "06-DPL", driver )
+Dpl06Laser::Dpl06Laser( const std::string& wavelength, LaserDriver* driver, const LaserCapabilities& capabilities, const Logger* logger ) :
+    Laser( "06-DPL", driver, capabilities, logger )
 {
     currentUnit_ = Milliamperes;
     powerUnit_ = Milliwatts;
+    telemetryCacheTimeToLiveMs_ = 100;
+    telemetryStaleWhileRevalidateMs_ = 400;
 
     CreateNameProperty();
     CreateModelProperty();
@@ -100,6 +102,7 @@ void Dpl06Laser::CreateLaserStateProperty()
     }
 
     RegisterPublicProperty( laserStateProperty_ );
+    RegisterTelemetryProperty( laserStateProperty_ );
 }
 
 void Dpl06Laser::CreateRunModeProperty()
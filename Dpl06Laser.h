@@ -49,7 +49,7 @@ class Dpl06Laser : public Laser
 {
 public:
 
-    Dpl06Laser( const std::string& wavelength, LaserDriver* device );
+    Dpl06Laser( const std::string& wavelength, LaserDriver* device, const LaserCapabilities& capabilities, const Logger* logger );
 
 protected: 
     
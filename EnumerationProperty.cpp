@@ -40,7 +40,8 @@
 NAMESPACE_COBOLT_BEGIN
 
 EnumerationProperty::EnumerationProperty( const std::string& name, LaserDriver* laserDriver, const std::string& getCommand ) :
-    MutableDeviceProperty( Property::String, name, laserDriver, getCommand )
+    MutableDeviceProperty( Property::String, name, laserDriver, getCommand ),
+    itemIndex_( NoItem )
 {}
 
 int EnumerationProperty::IntroduceToGuiEnvironment( GuiEnvironment* environment )
@@ -54,8 +55,8 @@ int EnumerationProperty::IntroduceToGuiEnvironment( GuiEnvironment* environment
             return returnCode;
         }
 
-        Logger::Instance()->LogMessage( "EnumerationProperty[ " + GetName() + " ]::IntroduceToGuiEnvironment(): Registered valid value '" +
-            enumerationItem->name + "' in GUI.", true );
+        COBOLT_LOG_DEBUG( GetLogger(), "EnumerationProperty[ " + GetName() + " ]::IntroduceToGuiEnvironment(): Registered valid value '" +
+            enumerationItem->name + "' in GUI." );
     }
 
     return return_code::ok;
@@ -63,49 +64,64 @@ int EnumerationProperty::IntroduceToGuiEnvironment( GuiEnvironment* environment
 
 void EnumerationProperty::RegisterEnumerationItem( const std::string& deviceValue, const std::string& setCommand, const std::string& name )
 {
-    Logger::Instance()->LogMessage( "EnumerationProperty[ " + GetName() + " ]::RegisterEnumerationItem( { '" + 
-        deviceValue + "' , '" + setCommand + "', '" + name + "' } )", true );
-
     EnumerationItem enumerationItem = { deviceValue, setCommand, name };
 
+    // The first item registered for a value wins (insert does not overwrite):
+    itemIndexByDeviceValue_.insert( item_index_t::value_type( deviceValue, (int) enumerationItems_.size() ) );
+    itemIndexByName_.insert( item_index_t::value_type( name, (int) enumerationItems_.size() ) );
+
     enumerationItems_.push_back( enumerationItem );
 }
 
 int EnumerationProperty::GetValue( std::string& string ) const
 {
+    // Keeps itemIndex_ up to date whenever the laser has to be queried:
     std::string deviceValue;
-    Parent::GetValue( deviceValue );
+    const int returnCode = Parent::GetValue( deviceValue );
 
-    string = ResolveEnumerationItem( deviceValue );
-    
-    if ( string == "" ) {
+    const int itemIndex = itemIndex_;
+
+    if ( returnCode != return_code::ok || itemIndex == NoItem ) {
 
         SetToUnknownValue( string );
-        Logger::Instance()->LogError( "EnumerationProperty[" + GetName() + "]::GetValue( ... ): No matching GUI value found for command value '" + deviceValue + "'" );
         return return_code::error; // Not 'invalid_value', as the cause is not the user.
     }
 
+    string = enumerationItems_[ itemIndex ].name;
+
     return return_code::ok;
 }
 
 int EnumerationProperty::SetValue( const std::string& enumerationItemName )
 {
-    for ( enumeration_items_t::const_iterator enumerationItem = enumerationItems_.begin();
-          enumerationItem != enumerationItems_.end();
-          enumerationItem++ ) {
+    const int itemIndex = FindItemByName( enumerationItemName );
 
-        if ( enumerationItemName == enumerationItem->name ) {
-            return laserDriver_->SendCommand( enumerationItem->setCommand );
-        }
+    if ( itemIndex == NoItem ) {
+
+        GetLogger()->LogError( "EnumerationProperty[ " + GetName() + " ]::SetValue(): Invalid enumeration item '" + enumerationItemName + "'" );
+        return return_code::invalid_property_value;
     }
 
-    Logger::Instance()->LogError( "EnumerationProperty[ " + GetName() + " ]::SetValue(): Invalid enumeration item '" + enumerationItemName + "'" );
-    return return_code::invalid_property_value;
+    return laserDriver_->SendCommand( enumerationItems_[ itemIndex ].setCommand, NULL, commandPriority_ );
 }
 
 bool EnumerationProperty::IsValidValue( const std::string& enumerationItemName )
 {
-    return ( ResolveDeviceValue( enumerationItemName ) != "" );
+    return ( FindItemByName( enumerationItemName ) != NoItem );
+}
+
+/**
+ * \brief Looks the enumeration item up once per reply from the laser, rather than on every read.
+ */
+void EnumerationProperty::OnDeviceValueReceived( const std::string& deviceValue ) const
+{
+    const int itemIndex = FindItemByDeviceValue( deviceValue );
+
+    if ( itemIndex == NoItem ) {
+        GetLogger()->LogError( "EnumerationProperty[" + GetName() + "]::OnDeviceValueReceived( ... ): No matching GUI value found for command value '" + deviceValue + "'" );
+    }
+
+    itemIndex_ = itemIndex;
 }
 
 /**
@@ -113,16 +129,13 @@ bool EnumerationProperty::IsValidValue( const std::string& enumerationItemName )
  */
 std::string EnumerationProperty::ResolveDeviceValue( const std::string& guiValue ) const
 {
-    for ( enumeration_items_t::const_iterator enumerationItem = enumerationItems_.begin();
-        enumerationItem != enumerationItems_.end();
-        enumerationItem++ ) {
+    const int itemIndex = FindItemByName( guiValue );
 
-        if ( guiValue == enumerationItem->name ) {
-            return enumerationItem->deviceValue;
-        }
+    if ( itemIndex == NoItem ) {
+        return "";
     }
 
-    return "";
+    return enumerationItems_[ itemIndex ].deviceValue;
 }
 
 /**
@@ -130,19 +143,35 @@ std::string EnumerationProperty::ResolveDeviceValue( const std::string& guiValue
  */
 std::string EnumerationProperty::ResolveEnumerationItem( const std::string& deviceValue ) const
 {
-    std::string enumerationItemName;
+    const int itemIndex = FindItemByDeviceValue( deviceValue );
 
-    for ( enumeration_items_t::const_iterator enumerationItem = enumerationItems_.begin();
-        enumerationItem != enumerationItems_.end();
-        enumerationItem++ ) {
+    if ( itemIndex == NoItem ) {
+        return "";
+    }
 
-        if ( enumerationItem->deviceValue == deviceValue ) {
-            enumerationItemName = enumerationItem->name;
-            break;
-        }
+    return enumerationItems_[ itemIndex ].name;
+}
+
+int EnumerationProperty::FindItemByDeviceValue( const std::string& deviceValue ) const
+{
+    item_index_t::const_iterator item = itemIndexByDeviceValue_.find( deviceValue );
+
+    if ( item == itemIndexByDeviceValue_.end() ) {
+        return NoItem;
+    }
+
+    return item->second;
+}
+
+int EnumerationProperty::FindItemByName( const std::string& name ) const
+{
+    item_index_t::const_iterator item = itemIndexByName_.find( name );
+
+    if ( item == itemIndexByName_.end() ) {
+        return NoItem;
     }
 
-    return enumerationItemName;
+    return item->second;
 }
 
 NAMESPACE_COBOLT_END
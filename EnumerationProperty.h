@@ -37,6 +37,9 @@
 #ifndef __COBOLT__ENUMERATION_PROPERTY_H
 #define __COBOLT__ENUMERATION_PROPERTY_H
 
+#include <atomic>
+#include <map>
+
 #include "MutableDeviceProperty.h"
 
 NAMESPACE_COBOLT_BEGIN
@@ -49,6 +52,8 @@ class EnumerationProperty : public MutableDeviceProperty
     typedef MutableDeviceProperty Parent;
 
 public:
+
+    static const int NoItem = -1;
     
     EnumerationProperty( const std::string& name, LaserDriver* laserDriver, const std::string& getCommand );
 
@@ -66,11 +71,16 @@ public:
 
 protected:
 
+    virtual void OnDeviceValueReceived( const std::string& deviceValue ) const;
+
     bool IsValidValue( const std::string& guiValue );
 
     std::string ResolveDeviceValue( const std::string& guiValue ) const;
     std::string ResolveEnumerationItem( const std::string& deviceValue ) const;
 
+    int FindItemByDeviceValue( const std::string& deviceValue ) const;
+    int FindItemByName( const std::string& name ) const;
+
 private:
 
     struct EnumerationItem
@@ -81,8 +91,18 @@ private:
     };
 
     typedef std::vector<EnumerationItem> enumeration_items_t;
+    typedef std::map<std::string, int> item_index_t;
 
     enumeration_items_t enumerationItems_;
+
+    item_index_t itemIndexByDeviceValue_;
+    item_index_t itemIndexByName_;
+
+    /**
+     * \brief The value, as the index of its enumeration item in order of registration (NoItem if
+     *        unknown). The item name is only looked up when the value is presented as a string.
+     */
+    mutable std::atomic<int> itemIndex_;
 };
 
 NAMESPACE_COBOLT_END
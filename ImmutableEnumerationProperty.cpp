@@ -45,9 +45,6 @@ ImmutableEnumerationProperty::ImmutableEnumerationProperty( const std::string& n
 
 void ImmutableEnumerationProperty::RegisterEnumerationItem( const std::string& deviceValue, const std::string& name )
 {
-    Logger::Instance()->LogMessage( "ImmutableEnumerationProperty[ " + GetName() + " ]::RegisterEnumerationItem( { '" + 
-        deviceValue + "', '" + name + "' } )", true );
-
     EnumerationItem enumerationItem = { deviceValue, name };
 
     enumerationItems_.push_back( enumerationItem );
@@ -63,7 +60,7 @@ int ImmutableEnumerationProperty::GetValue( std::string& string ) const
     if ( string == "" ) {
 
         SetToUnknownValue( string );
-        Logger::Instance()->LogError( "ImmutableEnumerationProperty[" + GetName() + "]::GetValue( ... ): No matching GUI value found for command value '" + deviceValue + "'" );
+        GetLogger()->LogError( "ImmutableEnumerationProperty[" + GetName() + "]::GetValue( ... ): No matching GUI value found for command value '" + deviceValue + "'" );
         return return_code::error;
     }
 
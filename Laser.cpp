@@ -68,12 +68,16 @@ const std::string Laser::EnumerationItem_RunMode_Modulation = "Modulation";
 
 int Laser::NextId__ = 1;
 
-Laser::Laser( const std::string& name, LaserDriver* driver ) :
-    id_( std::to_string( (long double) NextId__++ ) ),
+Laser::Laser( const std::string& name, LaserDriver* driver, const LaserCapabilities& capabilities, const Logger* logger ) :
+    id_( std::to_string( (long long) NextId__++ ) ),
     name_( name ),
     laserDriver_( driver ),
+    logger_( logger ),
+    capabilities_( capabilities ),
     currentUnit_( "?" ),
     powerUnit_( "?" ),
+    telemetryCacheTimeToLiveMs_( 0 ),
+    telemetryStaleWhileRevalidateMs_( 0 ),
     laserOnOffProperty_( NULL ),
     shutter_( NULL )
 {
@@ -104,6 +108,11 @@ const std::string& Laser::GetName() const
     return name_;
 }
 
+const Logger* Laser::GetLogger() const
+{
+    return logger_;
+}
+
 void Laser::SetOn( const bool on )
 {
     // Reset shutter on laser on/off:
@@ -116,9 +125,9 @@ void Laser::SetOn( const bool on )
     } else {
         
         if ( on ) {
-            laserDriver_->SendCommand( "restart" );
+            laserDriver_->SendCommand( "restart", NULL, LaserDriver::Emission );
         } else {
-            laserDriver_->SendCommand( "abort" );
+            laserDriver_->SendCommand( "abort", NULL, LaserDriver::Emission );
         }
     }
 }
@@ -127,10 +136,15 @@ void Laser::SetShutterOpen( const bool open )
 {
     if ( shutter_ == NULL ) {
 
-        Logger::Instance()->LogError( "Laser::SetShutterOpen(): Shutter not available" );
+        logger_->LogError( "Laser::SetShutterOpen(): Shutter not available" );
         return;
     }
 
+    // Emit with the setpoints the user last asked for:
+    if ( open ) {
+        FlushPendingWrites();
+    }
+
     shutter_->SetValue( open ? LaserShutterProperty::Value_Open : LaserShutterProperty::Value_Closed );
 }
 
@@ -145,7 +159,7 @@ bool Laser::IsShutterEnabled() const
         return ( laserStateProperty_->AllowsShutter() );
     }
     
-    Logger::Instance()->LogError( "Laser::IsShutterEnabled(): Expected properties were not initialized" );
+    logger_->LogError( "Laser::IsShutterEnabled(): Expected properties were not initialized" );
     return false;
 }
 
@@ -153,7 +167,7 @@ bool Laser::IsShutterOpen() const
 {
     if ( shutter_ == NULL ) {
 
-        Logger::Instance()->LogError( "Laser::IsShutterOpen(): Shutter not available" );
+        logger_->LogError( "Laser::IsShutterOpen(): Shutter not available" );
         return false;
     }
 
@@ -180,6 +194,59 @@ Laser::PropertyIterator Laser::GetPropertyIteratorEnd()
     return properties_.end();
 }
 
+int Laser::PrefetchValues()
+{
+    LaserDriver::command_batch_t batch;
+    std::vector<DeviceProperty*> prefetchedProperties;
+
+    for ( PropertyIterator it = GetPropertyIteratorBegin(); it != GetPropertyIteratorEnd(); it++ ) {
+
+        DeviceProperty* deviceProperty = dynamic_cast<DeviceProperty*>( it->second );
+
+        if ( deviceProperty != NULL && deviceProperty->AppendPrefetchCommand( batch ) ) {
+            prefetchedProperties.push_back( deviceProperty );
+        }
+    }
+
+    if ( batch.empty() ) {
+        return return_code::ok;
+    }
+
+    const int returnCode = laserDriver_->SendCommandBatch( batch, LaserDriver::Telemetry );
+
+    for ( size_t i = 0; i < batch.size(); i++ ) {
+        prefetchedProperties[ i ]->SetPrefetchedReply( batch[ i ] );
+    }
+
+    return returnCode;
+}
+
+void Laser::FlushPendingWrites()
+{
+    for ( PropertyIterator it = GetPropertyIteratorBegin(); it != GetPropertyIteratorEnd(); it++ ) {
+
+        MutableDeviceProperty* mutableProperty = dynamic_cast<MutableDeviceProperty*>( it->second );
+
+        if ( mutableProperty != NULL ) {
+            mutableProperty->FlushPendingWrites();
+        }
+    }
+}
+
+void Laser::EnableTelemetryPolling( TelemetryPoller* poller )
+{
+    for ( std::vector<DeviceProperty*>::iterator property = telemetryProperties_.begin(); property != telemetryProperties_.end(); property++ ) {
+        ( *property )->PollWith( poller );
+    }
+}
+
+void Laser::EnableSetpointWriteBehind( GuiEnvironment* guiEnvironment )
+{
+    for ( std::vector<MutableDeviceProperty*>::iterator property = setpointProperties_.begin(); property != setpointProperties_.end(); property++ ) {
+        ( *property )->EnableWriteBehind( guiEnvironment );
+    }
+}
+
 void Laser::CreateNameProperty()
 {
     RegisterPublicProperty( new StaticStringProperty( "Name", this->GetName() ) );
@@ -231,6 +298,7 @@ void Laser::CreateCurrentSetpointProperty()
    
     if ( IsShutterCommandSupported() || !IsInCdrhMode() ) {
         property = new NumericProperty<double>( "Current Setpoint [" + currentUnit_ + "]", laserDriver_, "glc?", "slc", 0.0f, MaxCurrentSetpoint() );
+        RegisterSetpointProperty( property );
     } else {
         property = new legacy::no_shutter_command::LaserCurrentProperty( "Current Setpoint [" + currentUnit_ + "]", laserDriver_, "glc?", "slc", 0.0f, MaxCurrentSetpoint(), this );
     }
@@ -241,21 +309,22 @@ void Laser::CreateCurrentSetpointProperty()
 void Laser::CreateCurrentReadingProperty()
 {
     DeviceProperty* property = new DeviceProperty( Property::Float, "Measured Current [" + currentUnit_ + "]", laserDriver_, "i?" );
-    property->SetCaching( false );
     RegisterPublicProperty( property );
+    RegisterTelemetryProperty( property );
 }
 
 void Laser::CreatePowerSetpointProperty()
 {
     MutableDeviceProperty* property = new NumericProperty<double>( "Power Setpoint [" + powerUnit_ + "]", laserDriver_, "glp?", "slp", 0.0f, MaxPowerSetpoint() );
     RegisterPublicProperty( property );
+    RegisterSetpointProperty( property );
 }
 
 void Laser::CreatePowerReadingProperty()
 {
     DeviceProperty* property = new DeviceProperty( Property::String, "Power Reading [" + powerUnit_ + "]", laserDriver_, "pa?" );
-    property->SetCaching( false );
     RegisterPublicProperty( property );
+    RegisterTelemetryProperty( property );
 }
 
 void Laser::CreateLaserOnOffProperty()
@@ -303,15 +372,13 @@ void Laser::CreateAnalogModulationFlagProperty()
 
 void Laser::CreateModulationPowerSetpointProperty()
 {
-    std::string maxModulationPowerSetpointResponse;
-    if ( laserDriver_->SendCommand( "gmlp?", &maxModulationPowerSetpointResponse ) != return_code::ok ) {
+    double maxModulationPowerSetpoint;
+    if ( !capabilities_.GetMaxPowerSetpoint( LaserCapabilities::LaserWide, maxModulationPowerSetpoint ) ) {
 
-        Logger::Instance()->LogError( "Laser::CreatePowerSetpointProperty(): Failed to retrieve max power sepoint" );
+        logger_->LogError( "Laser::CreatePowerSetpointProperty(): Failed to retrieve max power sepoint" );
         return;
     }
     
-    const double maxModulationPowerSetpoint = atof( maxModulationPowerSetpointResponse.c_str() );
-    
     RegisterPublicProperty( new NumericProperty<double>( "Modulation Power Setpoint", laserDriver_, "glmp?", "slmp", 0, maxModulationPowerSetpoint ) );
 }
 
@@ -347,46 +414,56 @@ void Laser::CreateModulationHighPowerSetpointProperty()
 
 bool Laser::IsShutterCommandSupported() const // TODO: Split into IsShutterCommandSupported() and IsPauseCommandSupported()
 {
-    std::string response;
-    laserDriver_->SendCommand( "l0r", &response );
-    
-    return ( response.find( "OK" ) != std::string::npos );
+    return capabilities_.IsShutterCommandSupported();
 }
 
 bool Laser::IsInCdrhMode() const
 {
-    std::string response;
-    laserDriver_->SendCommand( "gas?", &response );
-
-    return ( response == "1" );
+    return capabilities_.IsInCdrhMode();
 }
 
 void Laser::RegisterPublicProperty( Property* property )
 {
     assert( property != NULL );
+    property->AttachLogger( logger_ );
     properties_[ property->GetName() ] = property;
 }
 
+void Laser::RegisterTelemetryProperty( DeviceProperty* property )
+{
+    assert( property != NULL );
+
+    property->SetCachePolicy( telemetryCacheTimeToLiveMs_, telemetryStaleWhileRevalidateMs_ );
+    telemetryProperties_.push_back( property );
+}
+
+void Laser::RegisterSetpointProperty( MutableDeviceProperty* property )
+{
+    assert( property != NULL );
+
+    setpointProperties_.push_back( property );
+}
+
 double Laser::MaxCurrentSetpoint()
 {
-    std::string maxCurrentSetpointResponse;
-    if ( laserDriver_->SendCommand( "gmlc?", &maxCurrentSetpointResponse ) != return_code::ok ) {
+    double maxCurrentSetpoint;
+    if ( !capabilities_.GetMaxCurrentSetpoint( LaserCapabilities::LaserWide, maxCurrentSetpoint ) ) {
 
-        Logger::Instance()->LogError( "Laser::MaxCurrentSetpoint(): Failed to retrieve max current sepoint" );
+        logger_->LogError( "Laser::MaxCurrentSetpoint(): Failed to retrieve max current sepoint" );
         return 0.0f;
     }
     
-    return atof( maxCurrentSetpointResponse.c_str() );
+    return maxCurrentSetpoint;
 }
 
 double Laser::MaxPowerSetpoint()
 {
-    std::string maxPowerSetpointResponse;
-    if ( laserDriver_->SendCommand( "gmlp?", &maxPowerSetpointResponse ) != return_code::ok ) {
+    double maxPowerSetpoint;
+    if ( !capabilities_.GetMaxPowerSetpoint( LaserCapabilities::LaserWide, maxPowerSetpoint ) ) {
 
-        Logger::Instance()->LogError( "Laser::MaxPowerSetpoint(): Failed to retrieve max power sepoint" );
+        logger_->LogError( "Laser::MaxPowerSetpoint(): Failed to retrieve max power sepoint" );
         return 0.0f;
     }
 
-    return atof( maxPowerSetpointResponse.c_str() );
+    return maxPowerSetpoint;
 }
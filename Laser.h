@@ -44,10 +44,13 @@
 
 #include "base.h"
 #include "Property.h"
+#include "LaserCapabilities.h"
 
 NAMESPACE_COBOLT_BEGIN
 
 class LaserDriver;
+class DeviceProperty;
+class TelemetryPoller;
 class LaserStateProperty;
 class LaserShutterProperty;
 class MutableDeviceProperty;
@@ -58,12 +61,13 @@ public:
 
     typedef std::map<std::string, cobolt::Property*>::iterator PropertyIterator;
 
-    Laser( const std::string& name, LaserDriver* driver );
+    Laser( const std::string& name, LaserDriver* driver, const LaserCapabilities& capabilities, const Logger* logger );
 
     virtual ~Laser();
 
     const std::string& GetId() const;
     const std::string& GetName() const;
+    const Logger* GetLogger() const;
 
     void SetOn( const bool );
     void SetShutterOpen( const bool );
@@ -78,6 +82,28 @@ public:
     PropertyIterator GetPropertyIteratorBegin();
     PropertyIterator GetPropertyIteratorEnd();
 
+    /**
+     * \brief Fetches the values of all properties that would otherwise query the laser one by one in
+     *        a single pipelined batch, for the reads of a refresh sweep to be served from.
+     */
+    int PrefetchValues();
+
+    /**
+     * \brief Blocks until setpoints recorded in write-behind mode have reached the laser.
+     */
+    void FlushPendingWrites();
+
+    /**
+     * \brief Hands the volatile readings (power, current, laser state) over to the poller.
+     */
+    void EnableTelemetryPolling( TelemetryPoller* poller );
+
+    /**
+     * \brief Switches the power and current setpoints to write-behind mode (see
+     *        MutableDeviceProperty::EnableWriteBehind()).
+     */
+    void EnableSetpointWriteBehind( GuiEnvironment* guiEnvironment );
+
 protected:
 
     static int NextId__;
@@ -131,19 +157,32 @@ protected:
     bool IsInCdrhMode() const;
 
     void RegisterPublicProperty( Property* );
+    void RegisterTelemetryProperty( DeviceProperty* );
+    void RegisterSetpointProperty( MutableDeviceProperty* );
 
     double MaxCurrentSetpoint();
     double MaxPowerSetpoint();
     
     std::map<std::string, cobolt::Property*> properties_;
+    std::vector<DeviceProperty*> telemetryProperties_;
+    std::vector<MutableDeviceProperty*> setpointProperties_;
     
     std::string id_;
     std::string name_;
     LaserDriver* laserDriver_;
+    const Logger* logger_;
+    LaserCapabilities capabilities_;
 
     std::string currentUnit_;
     std::string powerUnit_;
 
+    /**
+     * Cache policy of the telemetry properties (see DeviceProperty::SetCachePolicy()), to be set by
+     * the model before the properties are created. Defaults to no caching.
+     */
+    int telemetryCacheTimeToLiveMs_;
+    int telemetryStaleWhileRevalidateMs_;
+
     LaserStateProperty* laserStateProperty_;
     MutableDeviceProperty* laserOnOffProperty_;
     LaserShutterProperty* shutter_;
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       LaserCapabilities.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#include <assert.h>
+#include "LaserCapabilities.h"
+#include "LaserDriver.h"
+#include "Logger.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+LaserCapabilities::LaserCapabilities() :
+    isShutterCommandSupported_( false ),
+    isInCdrhMode_( false )
+{}
+
+int LaserCapabilities::Probe( LaserDriver* driver, const std::vector<int>& lines, const Logger* logger )
+{
+    assert( driver != NULL );
+
+    LaserDriver::command_batch_t batch;
+
+    batch.push_back( LaserDriver::BatchedCommand( "l0r" ) ); // TODO: Split into shutter and pause command support
+    batch.push_back( LaserDriver::BatchedCommand( "gas?" ) );
+
+    for ( std::vector<int>::const_iterator line = lines.begin(); line != lines.end(); line++ ) {
+
+        assert( *line >= LaserWide && *line <= MaxLineCount );
+
+        batch.push_back( LaserDriver::BatchedCommand( MakeLineCommand( "gmlc?", *line ) ) );
+        batch.push_back( LaserDriver::BatchedCommand( MakeLineCommand( "gmlp?", *line ) ) );
+    }
+
+    const int returnCode = driver->SendCommandBatch( batch );
+
+    isShutterCommandSupported_ = ( batch[ 0 ].returnCode == return_code::ok && batch[ 0 ].response.find( "OK" ) != std::string::npos );
+    isInCdrhMode_ = ( batch[ 1 ].returnCode == return_code::ok && batch[ 1 ].response == "1" );
+
+    LaserDriver::command_batch_t::const_iterator reply = batch.begin() + 2;
+
+    for ( std::vector<int>::const_iterator line = lines.begin(); line != lines.end(); line++ ) {
+
+        SetpointLimit& maxCurrentSetpoint = maxCurrentSetpoints_[ *line ];
+        maxCurrentSetpoint.isKnown = ( reply->returnCode == return_code::ok );
+        maxCurrentSetpoint.value = atof( reply->response.c_str() );
+        reply++;
+
+        SetpointLimit& maxPowerSetpoint = maxPowerSetpoints_[ *line ];
+        maxPowerSetpoint.isKnown = ( reply->returnCode == return_code::ok );
+        maxPowerSetpoint.value = atof( reply->response.c_str() );
+        reply++;
+    }
+
+    if ( returnCode != return_code::ok ) {
+        COBOLT_LOG_DEBUG( logger, "LaserCapabilities::Probe(): Some capabilities could not be probed" );
+    }
+
+    return returnCode;
+}
+
+bool LaserCapabilities::IsShutterCommandSupported() const
+{
+    return isShutterCommandSupported_;
+}
+
+bool LaserCapabilities::IsInCdrhMode() const
+{
+    return isInCdrhMode_;
+}
+
+bool LaserCapabilities::GetMaxCurrentSetpoint( const int line, double& maxCurrentSetpoint ) const
+{
+    assert( line >= LaserWide && line <= MaxLineCount );
+
+    maxCurrentSetpoint = maxCurrentSetpoints_[ line ].value;
+    return maxCurrentSetpoints_[ line ].isKnown;
+}
+
+bool LaserCapabilities::GetMaxPowerSetpoint( const int line, double& maxPowerSetpoint ) const
+{
+    assert( line >= LaserWide && line <= MaxLineCount );
+
+    maxPowerSetpoint = maxPowerSetpoints_[ line ].value;
+    return maxPowerSetpoints_[ line ].isKnown;
+}
+
+std::string LaserCapabilities::MakeLineCommand( const std::string& command, const int line )
+{
+    if ( line == LaserWide ) {
+        return command;
+    }
+
+    return std::to_string( (long long) line ) + command;
+}
+
+NAMESPACE_COBOLT_END
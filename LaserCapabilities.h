@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       LaserCapabilities.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__LASER_CAPABILITIES_H
+#define __COBOLT__LASER_CAPABILITIES_H
+
+#include <vector>
+
+#include "base.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+class LaserDriver;
+
+/**
+ * \brief Snapshot of the static capabilities of a laser, probed once with a single pipelined batch
+ *        and then consulted by the property generators, instead of every generator querying the
+ *        laser again.
+ */
+class LaserCapabilities
+{
+public:
+
+    /**
+     * \brief Line number addressing the laser as a whole (as opposed to a Skyra line).
+     */
+    static const int LaserWide = 0;
+    static const int MaxLineCount = 4;
+
+    LaserCapabilities();
+
+    /**
+     * \brief Probes shutter command support, CDRH mode and the max current and power setpoints of the
+     *        given lines (LaserWide and/or Skyra lines 1-MaxLineCount).
+     */
+    int Probe( LaserDriver* driver, const std::vector<int>& lines, const Logger* logger );
+
+    bool IsShutterCommandSupported() const;
+    bool IsInCdrhMode() const;
+
+    /**
+     * \brief Returns false if the setpoint limit of the line was not probed or could not be read.
+     */
+    bool GetMaxCurrentSetpoint( const int line, double& maxCurrentSetpoint ) const;
+    bool GetMaxPowerSetpoint( const int line, double& maxPowerSetpoint ) const;
+
+private:
+
+    struct SetpointLimit
+    {
+        SetpointLimit() : isKnown( false ), value( 0.0f ) {}
+
+        bool isKnown;
+        double value;
+    };
+
+    static std::string MakeLineCommand( const std::string& command, const int line );
+
+    bool isShutterCommandSupported_;
+    bool isInCdrhMode_;
+
+    SetpointLimit maxCurrentSetpoints_[ MaxLineCount + 1 ];
+    SetpointLimit maxPowerSetpoints_[ MaxLineCount + 1 ];
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__LASER_CAPABILITIES_H
\ No newline at end of file
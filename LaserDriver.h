@@ -38,6 +38,9 @@
 #define __COBOLT__LASER_DRIVER_H
 
 #include <string>
+#include <vector>
+
+#include "base.h"
 
 namespace cobolt
 {
@@ -45,10 +48,141 @@ namespace cobolt
     {
     public:
 
+        virtual ~LaserDriver() {}
+
+        /**
+         * \brief Urgency classes of commands, most urgent first. Drivers that queue commands serve
+         *        more urgent commands first.
+         */
+        enum Priority { Emission, Setpoint, Telemetry };
+
+        static const int PriorityCount = Telemetry + 1;
+
+        /**
+         * \brief One command of a command batch. The response and return code are filled in
+         *        when the batch is sent.
+         */
+        struct BatchedCommand
+        {
+            BatchedCommand( const std::string& command ) :
+                command( command ),
+                returnCode( return_code::error )
+            {}
+
+            std::string command;
+            std::string response;
+            int returnCode;
+        };
+
+        typedef std::vector<BatchedCommand> command_batch_t;
+
+        /**
+         * \brief Receives the outcome of a command sent with SendCommandAsync().
+         */
+        class Completion
+        {
+        public:
+
+            virtual void OnCommandCompleted( const std::string& command, int returnCode, const std::string& response ) = 0;
+        };
+
         /**
          * \brief Sends a command to the laser device. Returns true on success or false otherwise.
          */
         virtual int SendCommand( const std::string& command, std::string* response = NULL ) = 0;
+
+        /**
+         * \brief Same as above, but lets drivers that queue commands know how urgent the command is.
+         *        The default implementation ignores the priority.
+         */
+        virtual int SendCommand( const std::string& command, std::string* response, Priority priority )
+        {
+            return SendCommand( command, response );
+        }
+
+        /**
+         * \brief Sends all commands of the batch and collects their responses in order. Returns
+         *        return_code::ok if every command succeeded, otherwise the return code of the first
+         *        failed command. Per command return codes are found in the batch itself.
+         *
+         * The default implementation sends one command at a time. Drivers that can write several
+         * commands before reading the replies should override this.
+         */
+        virtual int SendCommandBatch( command_batch_t& batch )
+        {
+            int batchReturnCode = return_code::ok;
+
+            for ( command_batch_t::iterator entry = batch.begin(); entry != batch.end(); entry++ ) {
+
+                entry->response.clear();
+                entry->returnCode = SendCommand( entry->command, &entry->response );
+
+                if ( entry->returnCode != return_code::ok && batchReturnCode == return_code::ok ) {
+                    batchReturnCode = entry->returnCode;
+                }
+            }
+
+            return batchReturnCode;
+        }
+
+        /**
+         * \brief Same as above, but lets drivers that queue commands know how urgent the batch is.
+         *        The default implementation ignores the priority.
+         */
+        virtual int SendCommandBatch( command_batch_t& batch, Priority priority )
+        {
+            return SendCommandBatch( batch );
+        }
+
+        /**
+         * \brief Sends a command without waiting for it to complete, if the driver supports it. The
+         *        completion, if any, is notified once the reply has been received. It may be notified
+         *        from another thread than the calling one.
+         *
+         * The default implementation sends the command synchronously and notifies the completion
+         * before returning.
+         */
+        virtual void SendCommandAsync( const std::string& command, Completion* completion, Priority priority = Telemetry )
+        {
+            std::string response;
+            const int returnCode = SendCommand( command, &response, priority );
+
+            if ( completion != NULL ) {
+                completion->OnCommandCompleted( command, returnCode, response );
+            }
+        }
+
+    protected:
+
+        /**
+         * \brief Looks for "error", "Error" or "ERROR" in a single pass over the reply.
+         */
+        static bool IsErrorResponse( const std::string& response )
+        {
+            static const char lowerCase[] = "error";
+            static const char upperCase[] = "ERROR";
+            static const size_t length = sizeof( lowerCase ) - 1;
+
+            for ( size_t i = 0; i + length <= response.length(); i++ ) {
+
+                if ( response[ i ] != 'e' && response[ i ] != 'E' ) {
+                    continue;
+                }
+
+                // The letters after the first are either all lower case or all upper case:
+                const char* expected = ( response[ i + 1 ] == 'R' ? upperCase : lowerCase );
+
+                if ( response[ i ] == 'e' && expected == upperCase ) {
+                    continue;
+                }
+
+                if ( response.compare( i + 1, length - 1, expected + 1 ) == 0 ) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
     };
 }
 
@@ -57,59 +57,87 @@
 using namespace std;
 using namespace cobolt;
 
-Laser* LaserFactory::Create( LaserDriver* driver )
+Laser* LaserFactory::Create( LaserDriver* driver, const Logger* logger )
 {
     assert( driver != NULL );
     
-    std::string firmwareVersion;
-    if ( driver->SendCommand( "gfv?", &firmwareVersion ) != return_code::ok ) {
-        return NULL;
+    // Identify the laser in one round trip, including the Skyra sub-model queries, which other models
+    // simply reject:
+    LaserDriver::command_batch_t identification;
+    identification.push_back( LaserDriver::BatchedCommand( "gfv?" ) );
+    identification.push_back( LaserDriver::BatchedCommand( "glm?" ) );
+
+    for ( int line = 1; line <= LaserCapabilities::MaxLineCount; line++ ) {
+        identification.push_back( LaserDriver::BatchedCommand( std::to_string( (long long) line ) + "glm?" ) );
     }
 
-    std::string modelString;
-    if ( driver->SendCommand( "glm?", &modelString ) != return_code::ok ) {
+    driver->SendCommandBatch( identification );
+
+    if ( identification[ 0 ].returnCode != return_code::ok ||
+         identification[ 1 ].returnCode != return_code::ok ) {
         return NULL;
     }
+
+    const std::string& firmwareVersion = identification[ 0 ].response;
+    const std::string& modelString = identification[ 1 ].response;
     
     std::vector<std::string> modelTokens;
     DecomposeModelString( modelString, modelTokens );
     std::string wavelength = "Unknown";
     
     if ( modelTokens.size() > 0 ) {
-        wavelength = std::to_string( (_Longlong) atoi( modelTokens[ 0 ].c_str() ) ); // TODO: Verify this, modelTokens[ 0 ] seems to use wrong index for wavelength...
+        wavelength = std::to_string( (long long) atoi( modelTokens[ 0 ].c_str() ) ); // TODO: Verify this, modelTokens[ 0 ] seems to use wrong index for wavelength...
     }
 
     Laser* laser;
+    LaserCapabilities capabilities;
+    std::vector<int> probedLines;
+    const int laserWide = LaserCapabilities::LaserWide; // Copied, as push_back() would otherwise need the constant defined out of class.
 
     if ( modelString.find( "-06-91-" ) != std::string::npos ) {
 
-        laser = new Dpl06Laser( wavelength, driver );
+        probedLines.push_back( laserWide );
+        capabilities.Probe( driver, probedLines, logger );
+
+        laser = new Dpl06Laser( wavelength, driver, capabilities, logger );
 
     } else if ( modelString.find( "-06-01-" ) != std::string::npos ||
                 modelString.find( "-06-03-" ) != std::string::npos ) {
 
-        laser = new Mld06Laser( "06-MLD", driver );
+        probedLines.push_back( laserWide );
+        capabilities.Probe( driver, probedLines, logger );
+
+        laser = new Mld06Laser( "06-MLD", driver, capabilities, logger );
 
     } else if ( firmwareVersion.find( "9.001" ) != std::string::npos ) {
 
-        static const int numberOfLines = 4;
+        static const int numberOfLines = LaserCapabilities::MaxLineCount;
         bool enabledLines[ numberOfLines ];
-        std::string submodelString;
 
         for ( int i = 0; i < numberOfLines; i++ ) {
 
-            submodelString = "";
+            const LaserDriver::BatchedCommand& submodelReply = identification[ 2 + i ];
 
-            if ( driver->SendCommand( std::to_string( (long long) i + 1 ) + "glm?", &submodelString ) != return_code::ok ) {
+            if ( submodelReply.returnCode != return_code::ok ) {
                 return NULL;
             }
 
+            const std::string& submodelString = submodelReply.response;
+
             enabledLines[ i ] = ( submodelString.find( "MLD" ) != std::string::npos ||
                 submodelString.find( "DPL" ) != std::string::npos );
+
+            if ( enabledLines[ i ] ) {
+                probedLines.push_back( i + 1 );
+            }
         }
+
+        capabilities.Probe( driver, probedLines, logger );
         
         laser = new SkyraLaser(
             driver,
+            capabilities,
+            logger,
             enabledLines[ 0 ],
             enabledLines[ 1 ],
             enabledLines[ 2 ],
@@ -117,10 +145,10 @@ Laser* LaserFactory::Create( LaserDriver* driver )
 
     } else {
 
-        laser = new Laser( "Unknown", driver );
+        laser = new Laser( "Unknown", driver, capabilities, logger );
     }
     
-    Logger::Instance()->LogMessage( "Created laser '" + laser->GetName() + "'", true );
+    COBOLT_LOG_DEBUG( logger, "Created laser '" + laser->GetName() + "'" );
 
     laser->SetShutterOpen( false );
 
@@ -45,7 +45,7 @@ class LaserFactory
 {
 public:
 
-    static Laser* Create( LaserDriver* driver );
+    static Laser* Create( LaserDriver* driver, const Logger* logger );
 
 private:
 
@@ -47,6 +47,9 @@ LaserShutterProperty::LaserShutterProperty( const std::string& name, LaserDriver
     laser_( laser ),
     isOpen_( false )
 {
+    AttachLogger( laser_->GetLogger() );
+    SetCommandPriority( LaserDriver::Emission );
+
     RegisterEnumerationItem( "N/A", "l0r", Value_Closed );
     RegisterEnumerationItem( "N/A", "l1r", Value_Open );
 }
@@ -57,6 +60,9 @@ LaserShutterProperty::LaserShutterProperty( const std::string& name, LaserDriver
     laser_( laser ),
     isOpen_( false )
 {
+    AttachLogger( laser_->GetLogger() );
+    SetCommandPriority( LaserDriver::Emission );
+
     RegisterEnumerationItem( "N/A", closeCommand, Value_Closed );
     RegisterEnumerationItem( "N/A", openCommand, Value_Open );
 }
@@ -88,6 +94,19 @@ int LaserShutterProperty::SetValue( const std::string& value )
     return returnCode;
 }
 
+int LaserShutterProperty::OnGuiSetAction( GuiProperty& guiProperty )
+{
+    std::string value;
+    guiProperty.Get( value );
+
+    // Emit with the setpoints the user last asked for:
+    if ( value == Value_Open ) {
+        laser_->FlushPendingWrites();
+    }
+
+    return EnumerationProperty::OnGuiSetAction( guiProperty );
+}
+
 bool LaserShutterProperty::IsOpen() const
 {
     return isOpen_;
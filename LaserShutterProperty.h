@@ -56,6 +56,7 @@ public:
     
     virtual int GetValue( std::string& string ) const;
     virtual int SetValue( const std::string& );
+    virtual int OnGuiSetAction( GuiProperty& guiProperty );
 
     virtual bool IsOpen() const;
 
@@ -39,41 +39,56 @@
 NAMESPACE_COBOLT_BEGIN
 
 LaserStateProperty::LaserStateProperty( Property::Stereotype stereotype, const std::string& name, LaserDriver* laserDriver, const std::string& getCommand ) :
-    DeviceProperty( stereotype, name, laserDriver, getCommand )
-{}
+    DeviceProperty( stereotype, name, laserDriver, getCommand ),
+    state_( NULL )
+{
+    SetCaching( false );
+}
 
 void LaserStateProperty::RegisterState( const std::string& deviceValue, const std::string& guiValue, const bool allowsShutter )
 {
-    stateMap_[ deviceValue ] = guiValue;
-
-    if ( allowsShutter ) {
-        shutterAllowedStates_.insert( deviceValue );
-    }
+    State state = { guiValue, allowsShutter };
+    states_[ deviceValue ] = state;
 }
 
 int LaserStateProperty::GetValue( std::string& string ) const
 {
-    Parent::GetValue( string );
+    // Keeps state_ up to date whenever a new value is read or polled:
+    const int returnCode = Parent::GetValue( string );
+
+    const State* state = state_;
 
-    if ( stateMap_.find( string ) == stateMap_.end() ) {
+    if ( returnCode != return_code::ok || state == NULL ) {
         return return_code::unsupported_device_property_value;
     }
     
-    string = stateMap_.at( string );
+    string = state->guiValue;
     return return_code::ok;
 }
 
 bool LaserStateProperty::AllowsShutter() const
 {
     std::string deviceValue;
-    Parent::GetValue( deviceValue ); // Do not use local overload as it would translate deviceValue to guiValue.
 
-    return ( shutterAllowedStates_.find( deviceValue ) != shutterAllowedStates_.end() );
+    // Do not use local overload as it would translate deviceValue to guiValue:
+    if ( GetDeviceValue( deviceValue, LaserDriver::Emission ) != return_code::ok ) {
+        return false;
+    }
+
+    // The value just read rather than state_, which a concurrent refresh or poll may replace meanwhile:
+    state_map_t::const_iterator state = states_.find( deviceValue );
+
+    return ( state != states_.end() && state->second.allowsShutter );
 }
 
-bool LaserStateProperty::IsCacheEnabled() const
+/**
+ * \brief Looks the state up once per reply from the laser, rather than on every read.
+ */
+void LaserStateProperty::OnDeviceValueReceived( const std::string& deviceValue ) const
 {
-    return false;
+    state_map_t::const_iterator state = states_.find( deviceValue );
+
+    state_ = ( state != states_.end() ? &state->second : NULL );
 }
 
 NAMESPACE_COBOLT_END
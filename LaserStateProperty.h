@@ -38,8 +38,8 @@
 #define __COBOLT__LASER_STATE_PROPERTY_H
 
 #include "DeviceProperty.h"
+#include <atomic>
 #include <map>
-#include <set>
 
 NAMESPACE_COBOLT_BEGIN
 
@@ -58,12 +58,26 @@ public:
 
 protected:
 
-    bool IsCacheEnabled() const;
+    virtual void OnDeviceValueReceived( const std::string& deviceValue ) const;
 
 private:
 
-    std::map<std::string, std::string> stateMap_;
-    std::set<std::string> shutterAllowedStates_;
+    struct State
+    {
+        std::string guiValue;
+        bool allowsShutter;
+    };
+
+    typedef std::map<std::string, State> state_map_t;
+
+    /**
+     * \brief The states by device value, so that both GUI value and shutter permission resolve with a
+     *        single lookup.
+     */
+    state_map_t states_;
+
+    /// The current state, NULL if unknown (the map entries stay put once registered):
+    mutable std::atomic<const State*> state_;
 };
 
 NAMESPACE_COBOLT_END
@@ -37,8 +37,26 @@
 #ifndef __COBOLT__LOGGER
 #define __COBOLT__LOGGER
 
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+/**
+ * \brief Logs a debug message, only evaluating the message expression if debug logging is enabled.
+ */
+#define COBOLT_LOG_DEBUG( logger, message ) \
+    do { \
+        if ( ( logger )->IsDebugEnabled() ) { \
+            ( logger )->LogMessage( message, true ); \
+        } \
+    } while ( false )
+
 NAMESPACE_COBOLT_BEGIN
 
+/**
+ * \brief Logging endpoint of one device. Every device owns its logger, and the objects making up the
+ *        device (driver layers, laser, properties) log through a pointer to it.
+ */
 class Logger
 {
 public:
@@ -50,20 +68,41 @@ public:
         virtual void SendLogMessage( const char* message, bool debug ) const = 0;
     };
 
-    static Logger* Instance()
+    /**
+     * \brief A logger without gateway, dropping all messages. Used by objects not (yet) attached to a
+     *        device.
+     */
+    static const Logger* Detached()
     {
-        static Logger instance;
-        return &instance;
+        static const Logger detached;
+        return &detached;
     }
 
+    Logger() : gateway_( NULL ), isDebugEnabled_( true ) {}
+
     void SetupWithGateway( const Gateway* gateway )
     {
         gateway_ = gateway;
     }
+
+    /**
+     * \brief Disabled debug messages are dropped before they are formatted or reach the gateway.
+     *        Enabled by default, leaving it to the receiving end (e.g. the core's debug log
+     *        setting) whether to keep them.
+     */
+    void SetDebugEnabled( const bool enabled )
+    {
+        isDebugEnabled_ = enabled;
+    }
+
+    bool IsDebugEnabled() const
+    {
+        return ( gateway_ != NULL && isDebugEnabled_.load( std::memory_order_relaxed ) );
+    }
     
     virtual void LogMessage( const std::string& message, bool debug ) const
     {
-        if ( gateway_ == NULL ) {
+        if ( gateway_ == NULL || ( debug && !IsDebugEnabled() ) ) {
             return;
         }
         
@@ -84,9 +123,8 @@ public:
 
 private:
 
-    Logger() {}
-
     const Gateway* gateway_;
+    std::atomic<bool> isDebugEnabled_;
 };
 
 NAMESPACE_COBOLT_END
@@ -44,11 +44,13 @@
 using namespace std;
 using namespace cobolt;
 
-Mld06Laser::Mld06Laser( const std::string& wavelength, LaserDriver* driver ) :
-    Laser( "06-MLD", driver )
+Mld06Laser::Mld06Laser( const std::string& wavelength, LaserDriver* driver, const LaserCapabilities& capabilities, const Logger* logger ) :
+    Laser( "06-MLD", driver, capabilities, logger )
 {
     currentUnit_ = Milliamperes;
     powerUnit_ = Milliwatts;
+    telemetryCacheTimeToLiveMs_ = 100;
+    telemetryStaleWhileRevalidateMs_ = 400;
 
     CreateNameProperty();
     CreateModelProperty();
@@ -96,6 +98,7 @@ void Mld06Laser::CreateLaserStateProperty()
     }
 
     RegisterPublicProperty( laserStateProperty_ );
+    RegisterTelemetryProperty( laserStateProperty_ );
 }
 
 void Mld06Laser::CreateRunModeProperty()
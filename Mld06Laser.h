@@ -47,7 +47,7 @@ class Mld06Laser : public Laser
 {
 public:
 
-    Mld06Laser( const std::string& wavelength, LaserDriver* device );
+    Mld06Laser( const std::string& wavelength, LaserDriver* device, const LaserCapabilities& capabilities, const Logger* logger );
 
 protected:
 
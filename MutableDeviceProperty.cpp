@@ -40,9 +40,44 @@
 NAMESPACE_COBOLT_BEGIN
 
 MutableDeviceProperty::MutableDeviceProperty( const Property::Stereotype stereotype, const std::string& name, LaserDriver* laserDriver, const std::string& getCommand ) :
-    DeviceProperty( stereotype, name, laserDriver, getCommand )
+    DeviceProperty( stereotype, name, laserDriver, getCommand ),
+    commandPriority_( LaserDriver::Setpoint ),
+    isWriteBehindEnabled_( false ),
+    guiEnvironment_( NULL ),
+    isWriteInFlight_( false ),
+    hasPendingWrite_( false )
 {}
 
+void MutableDeviceProperty::EnableWriteBehind( GuiEnvironment* guiEnvironment )
+{
+    isWriteBehindEnabled_ = true;
+    guiEnvironment_ = guiEnvironment;
+}
+
+void MutableDeviceProperty::FlushPendingWrites()
+{
+    std::unique_lock<std::mutex> lock( writeMutex_ );
+
+    while ( isWriteInFlight_ ) {
+        writeCompleted_.wait( lock );
+    }
+}
+
+int MutableDeviceProperty::GetValue( std::string& string ) const
+{
+    {
+        std::lock_guard<std::mutex> lock( writeMutex_ );
+
+        if ( isWriteInFlight_ ) {
+
+            string = ( hasPendingWrite_ ? pendingValue_ : inFlightValue_ );
+            return return_code::ok;
+        }
+    }
+
+    return DeviceProperty::GetValue( string );
+}
+
 int MutableDeviceProperty::IntroduceToGuiEnvironment( GuiEnvironment* )
 {
     return return_code::ok;
@@ -58,27 +93,162 @@ int MutableDeviceProperty::OnGuiSetAction( GuiProperty& guiProperty )
     std::string value;
     guiProperty.Get( value );
 
-    // Protect against unnecessary eeprom writes:
-    if ( value == GetCachedValue() ) {
+    // Protect against unnecessary eeprom writes (while a write is on its way, the laser's value is yet to change):
+    if ( !IsWriteInFlight() && IsCurrentValue( value ) ) {
         return return_code::ok;
     }
 
-    const int returnCode = SetValue( value );
+    std::string setCommand;
+    int returnCode;
+
+    if ( isWriteBehindEnabled_ && ResolveSetCommand( value, setCommand ) ) {
+        returnCode = WriteBehind( value, setCommand );
+    } else {
+        returnCode = SetValue( value );
+    }
+
+    return CompleteGuiSetAction( guiProperty, value, returnCode );
+}
 
+/**
+ * \brief Reports the outcome of a set to the GUI property, which shows the value if the set succeeded.
+ */
+int MutableDeviceProperty::CompleteGuiSetAction( GuiProperty& guiProperty, const std::string& value, const int returnCode )
+{
     if ( returnCode != return_code::ok ) {
 
-        Logger::Instance()->LogError( "MutableDeviceProperty[" + GetName() + "]::OnGuiSetAction( GuiProperty( '" + value + "' ) ): Failed" );
+        GetLogger()->LogError( "MutableDeviceProperty[" + GetName() + "]::OnGuiSetAction( GuiProperty( '" + value + "' ) ): Failed" );
         SetToUnknownValue( guiProperty );
         return returnCode;
     }
 
     ClearCache();
 
-    Logger::Instance()->LogMessage( "MutableDeviceProperty[" + GetName() + "]::OnGuiSetAction( GuiProperty( '" + value + "' ) ): Succeeded", true );
+    COBOLT_LOG_DEBUG( GetLogger(), "MutableDeviceProperty[" + GetName() + "]::OnGuiSetAction( GuiProperty( '" + value + "' ) ): Succeeded" );
 
     guiProperty.Set( value );
 
     return return_code::ok;
 }
 
+void MutableDeviceProperty::OnCommandCompleted( const std::string& command, int returnCode, const std::string& response )
+{
+    bool isWriteCompletion;
+
+    {
+        std::lock_guard<std::mutex> lock( writeMutex_ );
+        isWriteCompletion = ( isWriteInFlight_ && command == inFlightCommand_ );
+    }
+
+    // Otherwise a background cache refresh:
+    if ( !isWriteCompletion ) {
+
+        DeviceProperty::OnCommandCompleted( command, returnCode, response );
+        return;
+    }
+
+    if ( returnCode != return_code::ok ) {
+        GetLogger()->LogError( "MutableDeviceProperty[" + GetName() + "]::OnCommandCompleted(): Write-behind of '" + command + "' failed" );
+    }
+
+    ClearCache();
+    OnWriteBehindCompleted( returnCode );
+
+    std::string nextCommand;
+    GuiEnvironment* rejectionRecipient = NULL;
+    std::string name;
+    std::string unknownValue;
+
+    {
+        std::lock_guard<std::mutex> lock( writeMutex_ );
+
+        if ( hasPendingWrite_ ) {
+
+            nextCommand = pendingCommand_;
+            inFlightCommand_ = pendingCommand_;
+            inFlightValue_ = pendingValue_;
+            hasPendingWrite_ = false;
+
+        } else {
+
+            // The set has already returned ok, and the GUI still shows the rejected value as no newer one is on its way:
+            if ( returnCode != return_code::ok ) {
+
+                rejectionRecipient = guiEnvironment_;
+                name = GetName();
+                unknownValue = GetUnknownGuiValue();
+            }
+
+            // Notified under the lock, as a flushing thread may delete the property as soon as it returns:
+            isWriteInFlight_ = false;
+            writeCompleted_.notify_all();
+        }
+    }
+
+    if ( nextCommand.length() > 0 ) {
+        laserDriver_->SendCommandAsync( nextCommand, this, commandPriority_ );
+    }
+
+    // Last, and without touching the property, as the core may read properties back from within the notification:
+    if ( rejectionRecipient != NULL ) {
+        rejectionRecipient->NotifyGuiPropertyChanged( name, unknownValue );
+    }
+}
+
+bool MutableDeviceProperty::ResolveSetCommand( const std::string& value, std::string& command ) const
+{
+    return false;
+}
+
+bool MutableDeviceProperty::IsCurrentValue( const std::string& value ) const
+{
+    return ( value == GetCachedValue() );
+}
+
+void MutableDeviceProperty::OnWriteBehindCompleted( const int returnCode )
+{}
+
+bool MutableDeviceProperty::IsWriteBehindEnabled() const
+{
+    return isWriteBehindEnabled_;
+}
+
+bool MutableDeviceProperty::IsWriteInFlight() const
+{
+    std::lock_guard<std::mutex> lock( writeMutex_ );
+    return isWriteInFlight_;
+}
+
+void MutableDeviceProperty::SetCommandPriority( const LaserDriver::Priority priority )
+{
+    commandPriority_ = priority;
+}
+
+/**
+ * \brief Records the value, and sends it right away unless a write is already on its way. Values
+ *        recorded while one is, replace each other and only the latest is sent when it completes.
+ */
+int MutableDeviceProperty::WriteBehind( const std::string& value, const std::string& setCommand )
+{
+    {
+        std::lock_guard<std::mutex> lock( writeMutex_ );
+
+        if ( isWriteInFlight_ ) {
+
+            pendingCommand_ = setCommand;
+            pendingValue_ = value;
+            hasPendingWrite_ = true;
+            return return_code::ok;
+        }
+
+        isWriteInFlight_ = true;
+        inFlightCommand_ = setCommand;
+        inFlightValue_ = value;
+    }
+
+    laserDriver_->SendCommandAsync( setCommand, this, commandPriority_ );
+
+    return return_code::ok;
+}
+
 NAMESPACE_COBOLT_END
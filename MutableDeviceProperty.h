@@ -37,6 +37,8 @@
 #ifndef __COBOLT__MUTABLE_DEVICE_PROPERTY_H
 #define __COBOLT__MUTABLE_DEVICE_PROPERTY_H
 
+#include <condition_variable>
+
 #include "DeviceProperty.h"
 
 NAMESPACE_COBOLT_BEGIN
@@ -49,10 +51,79 @@ public:
 
     MutableDeviceProperty( const Property::Stereotype stereotype, const std::string& name, LaserDriver* laserDriver, const std::string& getCommand );
 
+    /**
+     * \brief In write-behind mode a GUI set only records the value and returns. Only the latest
+     *        recorded value is sent, as soon as the previous write has completed, and reads return
+     *        it until then. Requires the property to support ResolveSetCommand(), or to hand its
+     *        writes to WriteBehind() itself like NumericProperty does. As the set has already
+     *        returned, a write the laser rejects is reported through the GUI environment.
+     */
+    void EnableWriteBehind( GuiEnvironment* guiEnvironment );
+
+    /**
+     * \brief Blocks until all recorded writes have reached the laser.
+     */
+    void FlushPendingWrites();
+
+    using Property::GetValue;
+    virtual int GetValue( std::string& string ) const;
+
     virtual int IntroduceToGuiEnvironment( GuiEnvironment* );
     virtual bool IsMutable() const;
     virtual int SetValue( const std::string& ) = 0;
     virtual int OnGuiSetAction( GuiProperty& guiProperty );
+
+    /// ###
+    /// LaserDriver::Completion API (write-behind)
+
+    virtual void OnCommandCompleted( const std::string& command, int returnCode, const std::string& response );
+
+protected:
+
+    /**
+     * \brief Resolves the command setting the given value, if the value can be set by a single
+     *        command. Returns false otherwise, which makes write-behind fall back to SetValue().
+     */
+    virtual bool ResolveSetCommand( const std::string& value, std::string& command ) const;
+
+    /**
+     * \brief Whether setting the value would leave the laser as it is, in which case the write is
+     *        skipped to spare the eeprom. Default compares with the cached value.
+     */
+    virtual bool IsCurrentValue( const std::string& value ) const;
+
+    /**
+     * \brief Called when a write-behind has completed. A value recorded meanwhile is sent next.
+     */
+    virtual void OnWriteBehindCompleted( const int returnCode );
+
+    bool IsWriteBehindEnabled() const;
+    bool IsWriteInFlight() const;
+
+    int WriteBehind( const std::string& value, const std::string& setCommand );
+    int CompleteGuiSetAction( GuiProperty& guiProperty, const std::string& value, const int returnCode );
+
+    /**
+     * \brief Sets the priority with which set commands of this property are sent. Default is
+     *        LaserDriver::Setpoint.
+     */
+    void SetCommandPriority( const LaserDriver::Priority priority );
+
+    LaserDriver::Priority commandPriority_;
+
+private:
+
+    bool isWriteBehindEnabled_;
+    GuiEnvironment* guiEnvironment_;
+
+    mutable std::mutex writeMutex_;
+    std::condition_variable writeCompleted_;
+    bool isWriteInFlight_;
+    bool hasPendingWrite_;
+    std::string inFlightCommand_;
+    std::string inFlightValue_;
+    std::string pendingCommand_;
+    std::string pendingValue_;
 };
 
 NAMESPACE_COBOLT_END
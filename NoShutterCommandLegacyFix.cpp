@@ -42,7 +42,7 @@ using namespace legacy::no_shutter_command;
 
 LaserShutterPropertyCdrh::LaserShutterPropertyCdrh( const std::string& name, LaserDriver* laserDriver, Laser* laser ) :
     cobolt::LaserShutterProperty( name, laserDriver, laser ),
-    laserStatePersistence_( laserDriver )
+    laserStatePersistence_( laserDriver, LaserDriver::Emission )
 {
     if ( laserStatePersistence_.PersistedStateExists() ) { // Without this GetIsShutterOpen() may return false negatives.
 
@@ -54,7 +54,7 @@ LaserShutterPropertyCdrh::LaserShutterPropertyCdrh( const std::string& name, Las
         if ( wasShutterClosed ) {
 
             if ( RestoreState() != return_code::ok ) {
-                Logger::Instance()->LogError( "LaserShutterPropertyCdrh::LaserShutterPropertyCdrh(...): Initialization failed" );
+                GetLogger()->LogError( "LaserShutterPropertyCdrh::LaserShutterPropertyCdrh(...): Initialization failed" );
                 return;
             }
         }
@@ -102,10 +102,10 @@ int LaserShutterPropertyCdrh::SetValue( const std::string& value )
             SaveState();
         }
 
-        returnCode = laserDriver_->SendCommand( "slc 0" );
+        returnCode = laserDriver_->SendCommand( "slc 0", NULL, LaserDriver::Emission );
         if ( returnCode != return_code::ok ) { return returnCode; }
 
-        returnCode = laserDriver_->SendCommand( "ecc" );
+        returnCode = laserDriver_->SendCommand( "ecc", NULL, LaserDriver::Emission );
         if ( returnCode != return_code::ok ) { return returnCode; }
         
     } else if ( value == Value_Open ) { // Shutter 'open' requested.
@@ -119,7 +119,7 @@ int LaserShutterPropertyCdrh::SetValue( const std::string& value )
 
     } else {
 
-        Logger::Instance()->LogMessage( "LaserShutterPropertyCdrh[" + GetName() + "]::SetValue( '" + value + "' ): Ignored request as requested state is already set", true );
+        COBOLT_LOG_DEBUG( GetLogger(), "LaserShutterPropertyCdrh[" + GetName() + "]::SetValue( '" + value + "' ): Ignored request as requested state is already set" );
     }
 
     return returnCode;
@@ -131,10 +131,10 @@ int LaserShutterPropertyCdrh::SaveState()
 
     std::string runmode, currentSetpoint;
     
-    returnCode = laserDriver_->SendCommand( "gam?", &runmode );
+    returnCode = laserDriver_->SendCommand( "gam?", &runmode, LaserDriver::Emission );
     if ( returnCode != return_code::ok ) { return returnCode; }
 
-    laserDriver_->SendCommand( "glc?", &currentSetpoint );
+    laserDriver_->SendCommand( "glc?", &currentSetpoint, LaserDriver::Emission );
     if ( returnCode != return_code::ok ) { return returnCode; }
 
     laserStatePersistence_.PersistState( IsOpen(), runmode, currentSetpoint );
@@ -164,16 +164,16 @@ int LaserShutterPropertyCdrh::RestoreState()
         enterRunmodeCommand = "em";
     } else {
 
-        Logger::Instance()->LogError( "LaserShutterPropertyCdrh[" + GetName() + "]::SaveState(): Unhandled runmode" );
+        GetLogger()->LogError( "LaserShutterPropertyCdrh[" + GetName() + "]::SaveState(): Unhandled runmode" );
         return return_code::error;
     }
 
     setCurrentSetpointCommand = "slc " + currentSetpoint;
     
-    returnCode = laserDriver_->SendCommand( enterRunmodeCommand );
+    returnCode = laserDriver_->SendCommand( enterRunmodeCommand, NULL, LaserDriver::Emission );
     if ( returnCode != return_code::ok ) { return returnCode; }
 
-    returnCode = laserDriver_->SendCommand( setCurrentSetpointCommand );
+    returnCode = laserDriver_->SendCommand( setCurrentSetpointCommand, NULL, LaserDriver::Emission );
     if ( returnCode != return_code::ok ) { return returnCode; }
 
     return returnCode;
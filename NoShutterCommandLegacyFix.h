@@ -52,14 +52,15 @@ namespace legacy
         { 
         public:
 
-            PersistedLaserState( LaserDriver* laserDriver ) :
-                laserDriver_( laserDriver )
+            PersistedLaserState( LaserDriver* laserDriver, const LaserDriver::Priority priority = LaserDriver::Setpoint ) :
+                laserDriver_( laserDriver ),
+                priority_( priority )
             {}
 
             bool PersistedStateExists() const
             {
                 std::string persistedValue;
-                laserDriver_->SendCommand( "gdsn?", &persistedValue );
+                laserDriver_->SendCommand( "gdsn?", &persistedValue, priority_ );
                 return IsValidPersistedState( persistedValue );
             }
             
@@ -72,7 +73,7 @@ namespace legacy
                 sprintf( valueToSave, "MM[%s;%s;%s]", isShutterOpenStr.c_str(), runmode.c_str(), currentSetpoint.c_str() );
                 const std::string saveCommand = "sdsn " + std::string( valueToSave );
 
-                return laserDriver_->SendCommand( saveCommand );
+                return laserDriver_->SendCommand( saveCommand, NULL, priority_ );
             }
 
             int PersistCurrentSetpoint( const std::string& currentSetpoint )
@@ -84,7 +85,7 @@ namespace legacy
                 sprintf( valueToSave, "MM[%s;%s;%s]", isShutterOpenStr.c_str(), runmode.c_str(), currentSetpoint.c_str() );
                 const std::string saveCommand = "sdsn " + std::string( valueToSave );
 
-                return laserDriver_->SendCommand( saveCommand );
+                return laserDriver_->SendCommand( saveCommand, NULL, priority_ );
             }
 
             int PersistState( const bool isShutterOpen, const std::string& runmode, const std::string& currentSetpoint )
@@ -93,7 +94,7 @@ namespace legacy
                 sprintf( valueToSave, "MM[%s;%s;%s]", ( isShutterOpen ? "1" : "0" ), runmode.c_str(), currentSetpoint.c_str() );
                 const std::string saveCommand = "sdsn " + std::string( valueToSave );
 
-                return laserDriver_->SendCommand( saveCommand );
+                return laserDriver_->SendCommand( saveCommand, NULL, priority_ );
             }
 
             int GetIsShutterOpen( bool& isShutterOpen ) const
@@ -125,14 +126,14 @@ namespace legacy
             int Fetch( std::string* isShutterOpen, std::string* runmode, std::string* currentSetpoint ) const
             {
                 std::string persistedValue;
-                laserDriver_->SendCommand( "gdsn?", &persistedValue );
+                laserDriver_->SendCommand( "gdsn?", &persistedValue, priority_ );
 
                 if ( !IsValidPersistedState( persistedValue ) ) {
                     return return_code::error;
                 }
                 
                 int separatorsFound = 0;
-                for ( int i = 2; i < persistedValue.length(); i++ ) {
+                for ( size_t i = 2; i < persistedValue.length(); i++ ) {
 
                     if ( persistedValue[ i ] == '[' || persistedValue[ i ] == ']' ) {
                         continue;
@@ -164,6 +165,7 @@ namespace legacy
             }
 
             LaserDriver* laserDriver_;
+            LaserDriver::Priority priority_;
         };
 
         class LaserCurrentProperty : public NumericProperty<double>
@@ -184,6 +186,15 @@ namespace legacy
                 return false;
             }
 
+            /**
+             * \brief While the shutter is closed, sets only go to the persisted state, so the laser's
+             *        setpoint says nothing about whether a set is redundant.
+             */
+            virtual bool IsCurrentNumericValue( const double numericValue ) const
+            {
+                return false;
+            }
+
             virtual int GetValue( std::string& string ) const
             {
                 if ( laser_->IsShutterOpen() ) {
@@ -194,23 +205,18 @@ namespace legacy
                 }
             }
 
-            virtual int SetValue( const std::string& value )
+        protected:
+
+            virtual int SetNumericValue( const double numericValue, const std::string& value )
             {
-                int returnCode = return_code::ok;
-                
                 if ( laser_->IsShutterOpen() ) {
 
-                    returnCode = Parent::SetValue( value );
+                    const int returnCode = Parent::SetNumericValue( numericValue, value );
                     if ( returnCode != return_code::ok ) { return returnCode; }
-
-                    returnCode = laserStatePersistence_.PersistCurrentSetpoint( value );
-
-                } else if ( Parent::IsValidValue( value ) ) { // Shutter closed.
-                    
-                    returnCode = laserStatePersistence_.PersistCurrentSetpoint( value );
                 }
 
-                return returnCode;
+                // With the shutter closed, the setpoint is only persisted:
+                return laserStatePersistence_.PersistCurrentSetpoint( value );
             }
 
         private:
@@ -239,7 +245,7 @@ namespace legacy
                 // Prevent enabling of caching:
                 Parent::SetCaching( false );
                 if ( enabled ) {
-                    Logger::Instance()->LogMessage( "LaserCurrentProperty::SetCaching(...): overriding request to enable caching - caching remains disabled", true );
+                    COBOLT_LOG_DEBUG( GetLogger(), "LaserCurrentProperty::SetCaching(...): overriding request to enable caching - caching remains disabled" );
                 }
             }
 
@@ -346,6 +352,9 @@ namespace legacy
                     userValue_( "" ),
                     laser_( laser )
                 {
+                    // Line activation is what shutters a Skyra:
+                    SetCommandPriority( LaserDriver::Emission );
+
                     RegisterEnumerationItem( "0", std::to_string( (long long) line ) + "sla 0", Value_Inactive );
                     RegisterEnumerationItem( "1", std::to_string( (long long) line ) + "sla 1", Value_Active );
                 }
@@ -37,20 +37,30 @@
 #ifndef __COBOLT__NUMERIC_PROPERTY_H
 #define __COBOLT__NUMERIC_PROPERTY_H
 
+#include <cctype>
+
 #include "MutableDeviceProperty.h"
 
 NAMESPACE_COBOLT_BEGIN
 
+template <typename T> Property::Stereotype ResolveNumericStereotype();
+template <> inline Property::Stereotype ResolveNumericStereotype<int>() { return Property::Integer; }
+template <> inline Property::Stereotype ResolveNumericStereotype<double>() { return Property::Float; }
+
 template <typename T>
 class NumericProperty : public MutableDeviceProperty
 {
 public:
 
     NumericProperty( const std::string& name, LaserDriver* laserDriver, const std::string& getCommand, const std::string& setCommandBase, const T min, const T max ) :
-        MutableDeviceProperty( ResolveStereotype<T>(), name, laserDriver, getCommand ),
+        MutableDeviceProperty( ResolveNumericStereotype<T>(), name, laserDriver, getCommand ),
         setCommandBase_( setCommandBase ),
         min_( min ),
-        max_( max )
+        max_( max ),
+        hasConfirmedValue_( false ),
+        confirmedValue_( 0 ),
+        tolerance_( 0 ),
+        writtenValue_( 0 )
     {}
 
     virtual int IntroduceToGuiEnvironment( GuiEnvironment* environment )
@@ -60,33 +70,185 @@ public:
 
     virtual int SetValue( const std::string& value )
     {
-        if ( !IsValidValue( value ) ) {
+        T numericValue;
 
-            Logger::Instance()->LogError( "NumericProperty[" + GetName() + "]::SetValue( ... ): Invalid value '" + value + "'" );
+        if ( !ParseValidValue( value, numericValue ) ) {
             return return_code::invalid_value;
         }
 
-        return laserDriver_->SendCommand( setCommandBase_ + " " + value );
+        return SetNumericValue( numericValue, value );
+    }
+
+    /**
+     * \brief Parses the GUI value once, and works with the number from there on.
+     */
+    virtual int OnGuiSetAction( GuiProperty& guiProperty )
+    {
+        std::string value;
+        guiProperty.Get( value );
+
+        T numericValue;
+
+        if ( !ParseValidValue( value, numericValue ) ) {
+            return CompleteGuiSetAction( guiProperty, value, return_code::invalid_value );
+        }
+
+        // Protect against unnecessary eeprom writes (while a write is on its way, the laser's value is yet to change):
+        if ( !IsWriteInFlight() && IsCurrentNumericValue( numericValue ) ) {
+            return return_code::ok;
+        }
+
+        int returnCode;
+
+        if ( IsWriteBehindEnabled() ) {
+
+            {
+                std::lock_guard<std::mutex> lock( confirmedValueMutex_ );
+                writtenValue_ = numericValue;
+            }
+
+            returnCode = WriteBehind( value, setCommandBase_ + " " + value );
+
+        } else {
+
+            returnCode = SetNumericValue( numericValue, value );
+        }
+
+        return CompleteGuiSetAction( guiProperty, value, returnCode );
     }
     
 protected:
 
-    bool IsValidValue( const std::string& value ) const
+    /**
+     * \brief Sets a value that has already been parsed and validated, value being its string form.
+     */
+    virtual int SetNumericValue( const T numericValue, const std::string& value )
+    {
+        const int returnCode = laserDriver_->SendCommand( setCommandBase_ + " " + value, NULL, commandPriority_ );
+
+        std::lock_guard<std::mutex> lock( confirmedValueMutex_ );
+        RecordSetResult( numericValue, returnCode );
+
+        return returnCode;
+    }
+
+    /**
+     * \brief Compares with the last value confirmed by the laser, so that e.g. "10" and "10.000" are
+     *        recognized as the same setpoint. Values closer than the resolution of the laser's
+     *        replies count as the same.
+     */
+    virtual bool IsCurrentNumericValue( const T numericValue ) const
+    {
+        std::lock_guard<std::mutex> lock( confirmedValueMutex_ );
+
+        return ( hasConfirmedValue_ &&
+                 confirmedValue_ - tolerance_ <= numericValue && numericValue <= confirmedValue_ + tolerance_ );
+    }
+
+    /**
+     * \brief Keeps the confirmed value in line with the laser, which may have been changed by others
+     *        (e.g. from the front panel, by another client or by a restart).
+     */
+    virtual void OnDeviceValueReceived( const std::string& deviceValue ) const
     {
-        T numericValue = (T) atof( value.c_str() );
-        return ( min_ <= numericValue && numericValue <= max_ );
+        T numericValue;
+        const bool isNumeric = Parse( deviceValue, numericValue );
+
+        std::lock_guard<std::mutex> lock( confirmedValueMutex_ );
+
+        hasConfirmedValue_ = isNumeric;
+        confirmedValue_ = numericValue;
+
+        if ( isNumeric ) {
+            tolerance_ = ResolveTolerance( deviceValue );
+        }
+    }
+
+    /**
+     * \brief Confirms the latest written value. If a newer value was recorded while this write was on
+     *        its way, that one is sent next, and its completion settles the confirmed value.
+     */
+    virtual void OnWriteBehindCompleted( const int returnCode )
+    {
+        std::lock_guard<std::mutex> lock( confirmedValueMutex_ );
+        RecordSetResult( writtenValue_, returnCode );
+    }
+
+    bool IsValidValue( const T value ) const
+    {
+        return ( min_ <= value && value <= max_ );
+    }
+
+    bool ParseValidValue( const std::string& value, T& numericValue ) const
+    {
+        if ( !Parse( value, numericValue ) || !IsValidValue( numericValue ) ) {
+
+            GetLogger()->LogError( "NumericProperty[" + GetName() + "]::ParseValidValue( ... ): Invalid value '" + value + "'" );
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Converts a GUI or device string to the native value type. Fails if the string does not
+     *        start with a number.
+     */
+    static bool Parse( const std::string& string, T& value )
+    {
+        const char* begin = string.c_str();
+        char* end;
+
+        value = (T) strtod( begin, &end );
+
+        return ( end != begin );
+    }
+
+    /**
+     * \brief Half the last decimal place of a device reply, e.g. 0.00005 for "0.0100". Replies without
+     *        decimals give no tolerance, as they may just be printed without trailing zeros.
+     */
+    static T ResolveTolerance( const std::string& deviceValue )
+    {
+        const size_t decimalPoint = deviceValue.find( '.' );
+
+        if ( decimalPoint == std::string::npos ) {
+            return 0;
+        }
+
+        double tolerance = 0.5;
+
+        for ( size_t i = decimalPoint + 1; i < deviceValue.length() && isdigit( (unsigned char) deviceValue[ i ] ); i++ ) {
+            tolerance /= 10;
+        }
+
+        return (T) tolerance;
     }
 
 private:
 
-    template <typename S>   static Property::Stereotype ResolveStereotype();
-    template <>             static Property::Stereotype ResolveStereotype<int>() { return Property::Integer; }
-    template <>             static Property::Stereotype ResolveStereotype<double>() { return Property::Float; }
-    
+    /**
+     * \brief Called with confirmedValueMutex_ held.
+     */
+    void RecordSetResult( const T value, const int returnCode )
+    {
+        // After a failed set, the laser's value is unknown:
+        hasConfirmedValue_ = ( returnCode == return_code::ok );
+        confirmedValue_ = value;
+    }
+
     std::string setCommandBase_;
 
     T min_;
     T max_;
+
+    mutable std::mutex confirmedValueMutex_;
+    mutable bool hasConfirmedValue_;
+    mutable T confirmedValue_;
+    mutable T tolerance_;
+
+    /// The latest value handed to write-behind:
+    T writtenValue_;
 }; 
 
 NAMESPACE_COBOLT_END
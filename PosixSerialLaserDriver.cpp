@@ -0,0 +1,416 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       PosixSerialLaserDriver.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#if !defined( _WIN32 )
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "PosixSerialLaserDriver.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+namespace
+{
+    const size_t g_MaxPipelineDepth = 8;
+    const char g_ReplyTerminator[] = "\r\n";
+
+    typedef std::chrono::steady_clock clock_t;
+
+    bool ResolveSpeed( const int baudRate, speed_t& speed )
+    {
+        switch ( baudRate ) {
+            case 9600:   speed = B9600;   return true;
+            case 19200:  speed = B19200;  return true;
+            case 38400:  speed = B38400;  return true;
+            case 57600:  speed = B57600;  return true;
+            case 115200: speed = B115200; return true;
+            case 230400: speed = B230400; return true;
+            default:                      return false;
+        }
+    }
+
+    /**
+     * \brief The milliseconds left until the deadline, 0 if it has passed.
+     */
+    int GetRemainingMs( const clock_t::time_point& deadline )
+    {
+        const long long remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>( deadline - clock_t::now() ).count();
+        return (int) std::max( 0LL, remainingMs );
+    }
+}
+
+PosixSerialLaserDriver::PosixSerialLaserDriver( const std::string& devicePath, const int baudRate, const int timeoutMs, const Logger* logger ) :
+    devicePath_( devicePath ),
+    baudRate_( baudRate ),
+    timeoutMs_( timeoutMs ),
+    logger_( logger ),
+    fd_( -1 )
+{}
+
+PosixSerialLaserDriver::~PosixSerialLaserDriver()
+{
+    Close();
+}
+
+int PosixSerialLaserDriver::Open()
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    if ( fd_ >= 0 ) {
+        return return_code::ok;
+    }
+
+    speed_t speed;
+
+    if ( !ResolveSpeed( baudRate_, speed ) ) {
+
+        logger_->LogError( "PosixSerialLaserDriver::Open(): Unsupported baud rate " + std::to_string( (long long) baudRate_ ) );
+        return return_code::invalid_value;
+    }
+
+    fd_ = open( devicePath_.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK );
+
+    if ( fd_ < 0 ) {
+
+        logger_->LogError( "PosixSerialLaserDriver::Open(): Failed to open '" + devicePath_ + "': " + strerror( errno ) );
+        return return_code::serial_port_undefined;
+    }
+
+    struct termios settings;
+
+    if ( tcgetattr( fd_, &settings ) != 0 ) {
+
+        logger_->LogError( "PosixSerialLaserDriver::Open(): '" + devicePath_ + "' is not a terminal" );
+        close( fd_ );
+        fd_ = -1;
+        return return_code::serial_port_undefined;
+    }
+
+    // 8N1 without flow control, echo or any translation of '\r' and '\n':
+    cfmakeraw( &settings );
+    settings.c_cflag |= ( CLOCAL | CREAD );
+    settings.c_cflag &= ~( CSTOPB | CRTSCTS );
+    settings.c_cc[ VMIN ] = 0;
+    settings.c_cc[ VTIME ] = 0;
+    cfsetispeed( &settings, speed );
+    cfsetospeed( &settings, speed );
+
+    if ( tcsetattr( fd_, TCSANOW, &settings ) != 0 ) {
+
+        logger_->LogError( "PosixSerialLaserDriver::Open(): Failed to configure '" + devicePath_ + "': " + strerror( errno ) );
+        close( fd_ );
+        fd_ = -1;
+        return return_code::error;
+    }
+
+    Purge();
+
+    COBOLT_LOG_DEBUG( logger_, "PosixSerialLaserDriver::Open(): Opened '" + devicePath_ + "' at " + std::to_string( (long long) baudRate_ ) + " baud" );
+
+    return return_code::ok;
+}
+
+void PosixSerialLaserDriver::Close()
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    if ( fd_ >= 0 ) {
+        close( fd_ );
+        fd_ = -1;
+    }
+
+    receiveBuffer_.clear();
+}
+
+bool PosixSerialLaserDriver::IsOpen() const
+{
+    return ( fd_ >= 0 );
+}
+
+int PosixSerialLaserDriver::SendCommand( const std::string& command, std::string* response )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    std::string reply;
+
+    // Split up into atomic commands if command is composite:
+    if ( command.find( '\r' ) != std::string::npos ) {
+
+        size_t atomicCommandBegin = 0;
+
+        for ( size_t atomicCommandEnd = command.find( '\r' );
+              atomicCommandEnd != std::string::npos;
+              atomicCommandEnd = command.find( '\r', atomicCommandBegin ) ) {
+
+            const int returnCode = SendAtomicCommand( command.substr( atomicCommandBegin, atomicCommandEnd - atomicCommandBegin ), reply );
+            atomicCommandBegin = atomicCommandEnd + 1;
+
+            if ( returnCode != return_code::ok ) {
+                return returnCode;
+            }
+        }
+
+        return return_code::ok;
+    }
+
+    const int returnCode = SendAtomicCommand( command, reply );
+
+    // Error replies are handed over too, as they tell what the laser did not accept:
+    if ( response != NULL && ( returnCode == return_code::ok || returnCode == return_code::unsupported_command ) ) {
+        response->swap( reply );
+    }
+
+    return returnCode;
+}
+
+/**
+ * \brief Pipelined like CoboltOfficial::SendCommandBatch(): up to g_MaxPipelineDepth commands are
+ *        written back to back before their replies are collected.
+ */
+int PosixSerialLaserDriver::SendCommandBatch( command_batch_t& batch )
+{
+    for ( command_batch_t::const_iterator entry = batch.begin(); entry != batch.end(); entry++ ) {
+
+        // Composite commands produce several replies each, fall back to sending one at a time:
+        if ( entry->command.find( '\r' ) != std::string::npos ) {
+            return LaserDriver::SendCommandBatch( batch );
+        }
+    }
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    int batchReturnCode = return_code::ok;
+
+    for ( size_t first = 0; first < batch.size(); first += g_MaxPipelineDepth ) {
+
+        const size_t end = std::min( batch.size(), first + g_MaxPipelineDepth );
+
+        transmitBuffer_.clear();
+
+        for ( size_t i = first; i < end; i++ ) {
+            transmitBuffer_.append( batch[ i ].command ).append( 1, '\r' );
+        }
+
+        int returnCode = WriteCommand( transmitBuffer_ );
+
+        for ( size_t i = first; i < end; i++ ) {
+
+            BatchedCommand& entry = batch[ i ];
+            entry.response.clear();
+
+            // After a failure the remaining replies cannot be paired with their commands:
+            if ( returnCode != return_code::ok ) {
+                entry.returnCode = returnCode;
+                continue;
+            }
+
+            entry.returnCode = ReadReply( entry.response );
+
+            if ( entry.returnCode != return_code::ok ) {
+
+                COBOLT_LOG_DEBUG( logger_, "PosixSerialLaserDriver::SendCommandBatch: No reply to '" + entry.command + "'" );
+                Purge();
+                returnCode = entry.returnCode;
+
+            } else if ( IsErrorResponse( entry.response ) ) {
+
+                COBOLT_LOG_DEBUG( logger_, "PosixSerialLaserDriver::SendCommandBatch: Sent: " + entry.command + " Reply received: " + entry.response );
+                entry.returnCode = return_code::unsupported_command;
+            }
+        }
+
+        for ( size_t i = first; i < end; i++ ) {
+
+            if ( batch[ i ].returnCode != return_code::ok && batchReturnCode == return_code::ok ) {
+                batchReturnCode = batch[ i ].returnCode;
+            }
+        }
+
+        if ( returnCode != return_code::ok ) {
+
+            // Do not keep writing to a port that failed the previous window:
+            for ( size_t i = end; i < batch.size(); i++ ) {
+
+                batch[ i ].response.clear();
+                batch[ i ].returnCode = return_code::error;
+            }
+
+            break;
+        }
+    }
+
+    return batchReturnCode;
+}
+
+int PosixSerialLaserDriver::SendAtomicCommand( const std::string& command, std::string& reply )
+{
+    transmitBuffer_.assign( command ).append( 1, '\r' );
+
+    int returnCode = WriteCommand( transmitBuffer_ );
+
+    if ( returnCode == return_code::ok ) {
+        returnCode = ReadReply( reply );
+    }
+
+    if ( returnCode != return_code::ok ) {
+
+        COBOLT_LOG_DEBUG( logger_, "PosixSerialLaserDriver::SendCommand: No reply to '" + command + "'" );
+        Purge();
+
+    } else if ( IsErrorResponse( reply ) ) {
+
+        COBOLT_LOG_DEBUG( logger_, "PosixSerialLaserDriver::SendCommand: Sent: " + command + " Reply received: " + reply );
+        returnCode = return_code::unsupported_command;
+    }
+
+    return returnCode;
+}
+
+int PosixSerialLaserDriver::WriteCommand( const std::string& data )
+{
+    if ( fd_ < 0 ) {
+        return return_code::serial_port_undefined;
+    }
+
+    const clock_t::time_point deadline = clock_t::now() + std::chrono::milliseconds( timeoutMs_ );
+    size_t written = 0;
+
+    while ( written < data.length() ) {
+
+        const ssize_t result = write( fd_, data.data() + written, data.length() - written );
+
+        if ( result >= 0 ) {
+            written += result;
+            continue;
+        }
+
+        if ( errno == EINTR ) {
+            continue;
+        }
+
+        if ( errno != EAGAIN && errno != EWOULDBLOCK ) {
+
+            logger_->LogError( "PosixSerialLaserDriver::WriteCommand(): " + std::string( strerror( errno ) ) );
+            return return_code::error;
+        }
+
+        struct pollfd pollFd = { fd_, POLLOUT, 0 };
+
+        if ( poll( &pollFd, 1, GetRemainingMs( deadline ) ) == 0 ) {
+            return return_code::serial_port_timeout;
+        }
+    }
+
+    return return_code::ok;
+}
+
+/**
+ * \brief Reads up to and including the next "\r\n", which is not included in the reply. Any bytes
+ *        following it are kept for the next call.
+ */
+int PosixSerialLaserDriver::ReadReply( std::string& reply )
+{
+    const clock_t::time_point deadline = clock_t::now() + std::chrono::milliseconds( timeoutMs_ );
+    size_t searchBegin = 0;
+
+    while ( true ) {
+
+        const size_t terminator = receiveBuffer_.find( g_ReplyTerminator, searchBegin );
+
+        if ( terminator != std::string::npos ) {
+
+            reply.assign( receiveBuffer_, 0, terminator );
+            receiveBuffer_.erase( 0, terminator + sizeof( g_ReplyTerminator ) - 1 );
+            return return_code::ok;
+        }
+
+        // The terminator may straddle two reads:
+        searchBegin = ( receiveBuffer_.empty() ? 0 : receiveBuffer_.length() - 1 );
+
+        const int remainingMs = GetRemainingMs( deadline );
+        struct pollfd pollFd = { fd_, POLLIN, 0 };
+        const int pollResult = poll( &pollFd, 1, remainingMs );
+
+        if ( pollResult == 0 ) {
+            return return_code::serial_port_timeout;
+        }
+
+        if ( pollResult < 0 ) {
+
+            if ( errno == EINTR ) {
+                continue;
+            }
+
+            logger_->LogError( "PosixSerialLaserDriver::ReadReply(): " + std::string( strerror( errno ) ) );
+            return return_code::error;
+        }
+
+        char buffer[ 256 ];
+        const ssize_t count = read( fd_, buffer, sizeof( buffer ) );
+
+        if ( count > 0 ) {
+
+            receiveBuffer_.append( buffer, count );
+
+        } else if ( count == 0 || ( errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK ) ) {
+
+            // Device gone (e.g. USB unplugged):
+            logger_->LogError( "PosixSerialLaserDriver::ReadReply(): Lost '" + devicePath_ + "'" );
+            return return_code::error;
+        }
+    }
+}
+
+void PosixSerialLaserDriver::Purge()
+{
+    if ( fd_ >= 0 ) {
+        tcflush( fd_, TCIFLUSH );
+    }
+
+    receiveBuffer_.clear();
+}
+
+NAMESPACE_COBOLT_END
+
+#endif // #if !defined( _WIN32 )
@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       PosixSerialLaserDriver.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__POSIX_SERIAL_LASER_DRIVER_H
+#define __COBOLT__POSIX_SERIAL_LASER_DRIVER_H
+
+#if !defined( _WIN32 )
+
+#include <mutex>
+#include <string>
+
+#include "base.h"
+#include "LaserDriver.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Talks to a laser over a serial device through raw termios, so that the cobolt core (Laser,
+ *        LaserFactory and the properties) can run without the Micro-Manager core, e.g. in headless
+ *        control services and benchmarks.
+ *
+ * The port is non-blocking and read through poll(). Commands are terminated with '\r' and replies
+ * are framed exactly on "\r\n", bytes past a reply being kept for the next one. This lets batches be
+ * pipelined like CoboltOfficial does. A missing reply makes the driver discard all pending input, as
+ * late replies could otherwise not be paired with their commands.
+ */
+class PosixSerialLaserDriver : public LaserDriver
+{
+public:
+
+    PosixSerialLaserDriver( const std::string& devicePath, const int baudRate, const int timeoutMs, const Logger* logger );
+    ~PosixSerialLaserDriver();
+
+    int Open();
+    void Close();
+    bool IsOpen() const;
+
+    /// ###
+    /// LaserDriver API
+
+    virtual int SendCommand( const std::string& command, std::string* response = NULL );
+    virtual int SendCommandBatch( command_batch_t& batch );
+
+private:
+
+    int SendAtomicCommand( const std::string& command, std::string& reply );
+
+    int WriteCommand( const std::string& command );
+    int ReadReply( std::string& reply );
+    void Purge();
+
+    const std::string devicePath_;
+    const int baudRate_;
+    const int timeoutMs_;
+    const Logger* logger_;
+
+    std::mutex mutex_;
+    int fd_;
+    std::string receiveBuffer_;
+    std::string transmitBuffer_;
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #if !defined( _WIN32 )
+
+#endif // #ifndef __COBOLT__POSIX_SERIAL_LASER_DRIVER_H
\ No newline at end of file
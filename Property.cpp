@@ -43,9 +43,10 @@ int Property::NextPropertyId_ = 1;
 
 Property::Property( const Stereotype stereotype, const std::string& name ) :
     stereotype_( stereotype ),
-    name_( name )
+    name_( name ),
+    logger_( Logger::Detached() )
 {
-    const std::string propertyIdStr = std::to_string( (long double) NextPropertyId_++ );
+    const std::string propertyIdStr = std::to_string( (long long) NextPropertyId_++ );
     name_ = ( std::string( 2 - propertyIdStr.length(), '0' ) + propertyIdStr ) + "-" + name;
 }
 
@@ -66,6 +67,16 @@ std::string Property::GetValue() const
     return value;
 }
 
+void Property::AttachLogger( const Logger* logger )
+{
+    logger_ = logger;
+}
+
+const Logger* Property::GetLogger() const
+{
+    return logger_;
+}
+
 Property::Stereotype Property::GetStereotype() const
 {
     return stereotype_;
@@ -78,7 +89,7 @@ bool Property::IsMutable() const
 
 int Property::OnGuiSetAction( GuiProperty& )
 {
-    Logger::Instance()->LogMessage( "Property[" + GetName() + "]::OnGuiSetAction(): Ignoring 'set' action on read-only property.", true );
+    COBOLT_LOG_DEBUG( GetLogger(), "Property[" + GetName() + "]::OnGuiSetAction(): Ignoring 'set' action on read-only property." );
     return return_code::ok;
 }
 
@@ -103,7 +114,7 @@ int Property::OnGuiGetAction( GuiProperty& guiProperty )
  */
 std::string Property::ObjectString() const
 {
-    return "stereotype = " + std::to_string( (long double) stereotype_ ) + "; name_ = " + name_ + "; ";
+    return "stereotype = " + std::to_string( (long long) stereotype_ ) + "; name_ = " + name_ + "; ";
 }
 
 void Property::SetToUnknownValue( std::string& string ) const
@@ -112,12 +123,22 @@ void Property::SetToUnknownValue( std::string& string ) const
 }
 
 void Property::SetToUnknownValue( GuiProperty& guiProperty ) const
+{
+    guiProperty.Set( GetUnknownGuiValue() );
+}
+
+/**
+ * \brief The value standing in for an unknown one in the GUI, valid for the property type.
+ */
+std::string Property::GetUnknownGuiValue() const
 {
     switch ( GetStereotype() ) {
-        case Float:   guiProperty.Set( "0" ); break;
-        case Integer: guiProperty.Set( "0" ); break;
-        case String:  guiProperty.Set( "Unknown" ); break;
+        case Float:   return "0";
+        case Integer: return "0";
+        case String:  return "Unknown";
     }
+
+    return "Unknown";
 }
 
 NAMESPACE_COBOLT_END
@@ -64,6 +64,11 @@ public:
 
     virtual int RegisterAllowedGuiPropertyValue( const std::string& propertyName, const std::string& value ) = 0;
     virtual int RegisterAllowedGuiPropertyRange( const std::string& propertyName, double min, double max ) = 0;
+
+    /**
+     * \brief Tells the GUI about a value change it did not ask for. Safe to call from any thread.
+     */
+    virtual void NotifyGuiPropertyChanged( const std::string& propertyName, const std::string& value ) = 0;
 };
 
 class Property
@@ -78,11 +83,17 @@ public:
     }
 
     Property( const Stereotype stereotype, const std::string& name );
+    virtual ~Property() {}
     
     virtual int IntroduceToGuiEnvironment( GuiEnvironment* );
 
     const std::string& GetName() const;
 
+    /**
+     * \brief Makes the property log through the logger of the device it belongs to.
+     */
+    void AttachLogger( const Logger* logger );
+
     std::string GetValue() const;
     virtual int GetValue( std::string& string ) const = 0;
 
@@ -101,6 +112,9 @@ protected:
 
     void SetToUnknownValue( std::string& string ) const;
     void SetToUnknownValue( GuiProperty& guiProperty ) const;
+    std::string GetUnknownGuiValue() const;
+
+    const Logger* GetLogger() const;
     
 private:
 
@@ -108,6 +122,7 @@ private:
 
     Stereotype stereotype_;
     std::string name_;
+    const Logger* logger_;
 };
 
 NAMESPACE_COBOLT_END
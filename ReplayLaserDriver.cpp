@@ -0,0 +1,168 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       ReplayLaserDriver.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "ReplayLaserDriver.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+ReplayLaserDriver::ReplayLaserDriver( const double timeScale, const Logger* logger ) :
+    timeScale_( timeScale ),
+    logger_( logger ),
+    nextRecord_( 0 )
+{}
+
+int ReplayLaserDriver::Load( const std::string& filePath )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    nextRecord_ = 0;
+
+    if ( TraceRecorder::Load( filePath, records_ ) != return_code::ok ) {
+
+        logger_->LogError( "ReplayLaserDriver::Load(): Failed to read trace file '" + filePath + "'" );
+        return return_code::error;
+    }
+
+    COBOLT_LOG_DEBUG( logger_, "ReplayLaserDriver::Load(): Loaded " + std::to_string( (long long) records_.size() ) + " records from '" + filePath + "'" );
+
+    return return_code::ok;
+}
+
+size_t ReplayLaserDriver::GetRemainingCount() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return ( records_.size() - nextRecord_ );
+}
+
+int ReplayLaserDriver::SendCommand( const std::string& command, std::string* response )
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    if ( nextRecord_ >= records_.size() ) {
+
+        logger_->LogError( "ReplayLaserDriver::SendCommand(): Trace exhausted, got '" + command + "'" );
+        return return_code::error;
+    }
+
+    const TraceRecord& record = records_[ nextRecord_ ];
+
+    if ( record.command != command ) {
+
+        logger_->LogError( "ReplayLaserDriver::SendCommand(): Expected '" + record.command + "', got '" + command + "'" );
+        return return_code::error;
+    }
+
+    nextRecord_++;
+
+    if ( response != NULL ) {
+        *response = record.response;
+    }
+
+    const int returnCode = record.returnCode;
+    const long delayUs = (long) ( record.durationUs * timeScale_ );
+
+    lock.unlock();
+
+    if ( delayUs > 0 ) {
+        std::this_thread::sleep_for( std::chrono::microseconds( delayUs ) );
+    }
+
+    return returnCode;
+}
+
+int ReplayLaserDriver::SendCommandBatch( command_batch_t& batch )
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    int batchReturnCode = return_code::ok;
+    long long batchStartUs = 0;
+    long long batchEndUs = 0;
+
+    for ( size_t i = 0; i < batch.size(); i++ ) {
+
+        BatchedCommand& entry = batch[ i ];
+        entry.response.clear();
+
+        const bool isMatching = ( nextRecord_ < records_.size() && records_[ nextRecord_ ].command == entry.command );
+
+        if ( !isMatching ) {
+
+            logger_->LogError( "ReplayLaserDriver::SendCommandBatch(): Expected '" + ( nextRecord_ < records_.size() ? records_[ nextRecord_ ].command : std::string( "end of trace" ) ) +
+                "', got '" + entry.command + "'" );
+
+            // As the laser would, having lost track of which reply belongs to which command:
+            for ( ; i < batch.size(); i++ ) {
+                batch[ i ].returnCode = return_code::error;
+            }
+
+            if ( batchReturnCode == return_code::ok ) {
+                batchReturnCode = return_code::error;
+            }
+
+            break;
+        }
+
+        const TraceRecord& record = records_[ nextRecord_++ ];
+
+        if ( i == 0 ) {
+            batchStartUs = record.startUs;
+        }
+
+        batchEndUs = std::max( batchEndUs, record.startUs + record.durationUs );
+
+        entry.response = record.response;
+        entry.returnCode = record.returnCode;
+
+        if ( entry.returnCode != return_code::ok && batchReturnCode == return_code::ok ) {
+            batchReturnCode = entry.returnCode;
+        }
+    }
+
+    const long delayUs = (long) ( ( batchEndUs - batchStartUs ) * timeScale_ );
+
+    lock.unlock();
+
+    if ( delayUs > 0 ) {
+        std::this_thread::sleep_for( std::chrono::microseconds( delayUs ) );
+    }
+
+    return batchReturnCode;
+}
+
+NAMESPACE_COBOLT_END
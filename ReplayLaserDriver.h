@@ -0,0 +1,91 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       ReplayLaserDriver.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__REPLAY_LASER_DRIVER_H
+#define __COBOLT__REPLAY_LASER_DRIVER_H
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base.h"
+#include "LaserDriver.h"
+#include "TraceRecorder.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Plays back a trace recorded by TraceRecorder in place of a laser, so that adapter changes can
+ *        be benchmarked and regression tested offline against the traffic of a real session.
+ *
+ * Commands must arrive in recorded order. Each is answered with the recorded reply and return code
+ * after its recorded duration times the time scale (1: original timing, 0: no delay). A command that
+ * does not match the next recorded one fails with return_code::error without consuming the record.
+ * A batch is answered after the time from the recorded start of its first command to its last
+ * reply, as its recorded durations overlap when the commands were pipelined.
+ */
+class ReplayLaserDriver : public LaserDriver
+{
+public:
+
+    ReplayLaserDriver( const double timeScale, const Logger* logger );
+
+    int Load( const std::string& filePath );
+
+    /**
+     * \brief The number of records not yet replayed.
+     */
+    size_t GetRemainingCount() const;
+
+    /// ###
+    /// LaserDriver API
+
+    virtual int SendCommand( const std::string& command, std::string* response = NULL );
+    virtual int SendCommandBatch( command_batch_t& batch );
+
+private:
+
+    const double timeScale_;
+    const Logger* logger_;
+
+    mutable std::mutex mutex_;
+    std::vector<TraceRecord> records_;
+    size_t nextRecord_;
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__REPLAY_LASER_DRIVER_H
\ No newline at end of file
@@ -51,14 +51,18 @@ using namespace cobolt;
 
 SkyraLaser::SkyraLaser(
     LaserDriver* driver,
+    const LaserCapabilities& capabilities,
+    const Logger* logger,
     const bool line1Enabled,
     const bool line2Enabled,
     const bool line3Enabled,
     const bool line4Enabled ) :
-    Laser( "Skyra", driver )
+    Laser( "Skyra", driver, capabilities, logger )
 {
     currentUnit_ = Milliamperes;
     powerUnit_ = Milliwatts;
+    telemetryCacheTimeToLiveMs_ = 100;
+    telemetryStaleWhileRevalidateMs_ = 400;
 
     CreateNameProperty();
     CreateModelProperty();
@@ -97,38 +101,38 @@ void SkyraLaser::CreateCurrentSetpointProperty( const int line )
         laserDriver_, MakeLineCommand( "glc?", line ), MakeLineCommand( "slc", line ), 0.0f, MaxCurrentSetpoint( line ) );
     
     RegisterPublicProperty( property );
+    RegisterSetpointProperty( property );
 }
 
 void SkyraLaser::CreateCurrentReadingProperty( const int line )
 {
     DeviceProperty* property = new DeviceProperty( Property::Float, MakeLineName( line ) + " Measured Current [" + currentUnit_ + "]",
         laserDriver_, MakeLineCommand( "i?", line ) );
-    property->SetCaching( false );
     RegisterPublicProperty( property );
+    RegisterTelemetryProperty( property );
 }
 
 void SkyraLaser::CreatePowerSetpointProperty( const int line )
 {
-    std::string maxPowerSetpointResponse;
-    if ( laserDriver_->SendCommand( MakeLineCommand( "gmlp?", line ), &maxPowerSetpointResponse ) != return_code::ok ) {
+    double maxPowerSetpoint;
+    if ( !capabilities_.GetMaxPowerSetpoint( line, maxPowerSetpoint ) ) {
 
-        Logger::Instance()->LogError( "SkyraLaser::CreatePowerSetpointProperty(): Failed to retrieve max power sepoint" );
+        logger_->LogError( "SkyraLaser::CreatePowerSetpointProperty(): Failed to retrieve max power sepoint" );
         return;
     }
-
-    const double maxPowerSetpoint = atof( maxPowerSetpointResponse.c_str() );
     
     MutableDeviceProperty* property = new NumericProperty<double>( MakeLineName( line ) + " Power Setpoint [" + powerUnit_ + "]",
         laserDriver_, MakeLineCommand( "glp?", line ), MakeLineCommand( "slp", line ), 0.0f, maxPowerSetpoint );
     RegisterPublicProperty( property );
+    RegisterSetpointProperty( property );
 }
 
 void SkyraLaser::CreatePowerReadingProperty( const int line )
 {
     DeviceProperty* property = new DeviceProperty( Property::String, MakeLineName( line ) + " Power Reading [" + powerUnit_ + "]",
         laserDriver_, MakeLineCommand( "pa?", line ) );
-    property->SetCaching( false );
     RegisterPublicProperty( property );
+    RegisterTelemetryProperty( property );
 }
 
 void SkyraLaser::CreateLaserStateProperty()
@@ -156,6 +160,7 @@ void SkyraLaser::CreateLaserStateProperty()
     }
 
     RegisterPublicProperty( laserStateProperty_ );
+    RegisterTelemetryProperty( laserStateProperty_ );
 }
 
 void SkyraLaser::CreateShutterProperty()
@@ -223,12 +228,12 @@ void SkyraLaser::CreateLineSpecificProperties( const int line )
 
 double SkyraLaser::MaxCurrentSetpoint( const int line )
 {
-    std::string maxCurrentSetpointResponse;
-    if ( laserDriver_->SendCommand( MakeLineCommand( "gmlc?", line ), &maxCurrentSetpointResponse ) != return_code::ok ) {
+    double maxCurrentSetpoint;
+    if ( !capabilities_.GetMaxCurrentSetpoint( line, maxCurrentSetpoint ) ) {
 
-        Logger::Instance()->LogError( "SkyraLaser::MaxCurrentSetpoint(): Failed to retrieve max current sepoint" );
+        logger_->LogError( "SkyraLaser::MaxCurrentSetpoint(): Failed to retrieve max current sepoint" );
         return 0.0f;
     }
 
-    return atof( maxCurrentSetpointResponse.c_str() );
+    return maxCurrentSetpoint;
 }
@@ -49,6 +49,8 @@ public:
     
     SkyraLaser(
         LaserDriver* driver,
+        const LaserCapabilities& capabilities,
+        const Logger* logger,
         const bool line1Enabled,
         const bool line2Enabled,
         const bool line3Enabled,
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       TelemetryPoller.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#include <assert.h>
+#include <chrono>
+#include "TelemetryPoller.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+TelemetryPoller::TelemetryPoller( LaserDriver* laserDriver, const int intervalMs, const Logger* logger ) :
+    laserDriver_( laserDriver ),
+    intervalMs_( intervalMs ),
+    logger_( logger ),
+    isStopRequested_( false )
+{
+    assert( laserDriver_ != NULL );
+}
+
+TelemetryPoller::~TelemetryPoller()
+{
+    Stop();
+
+    for ( snapshots_t::iterator snapshot = snapshots_.begin(); snapshot != snapshots_.end(); snapshot++ ) {
+        delete snapshot->second;
+    }
+}
+
+const ValueSnapshot* TelemetryPoller::Subscribe( const std::string& getCommand )
+{
+    assert( !pollThread_.joinable() );
+
+    snapshots_t::iterator snapshot = snapshots_.find( getCommand );
+
+    if ( snapshot != snapshots_.end() ) {
+        return snapshot->second;
+    }
+
+    ValueSnapshot* newSnapshot = new ValueSnapshot();
+    snapshots_[ getCommand ] = newSnapshot;
+    batch_.push_back( LaserDriver::BatchedCommand( getCommand ) );
+
+    COBOLT_LOG_DEBUG( logger_, "TelemetryPoller::Subscribe(): Polling '" + getCommand + "' every " + std::to_string( (long long) intervalMs_ ) + " ms" );
+
+    return newSnapshot;
+}
+
+void TelemetryPoller::Start()
+{
+    if ( pollThread_.joinable() || batch_.empty() ) {
+        return;
+    }
+
+    isStopRequested_ = false;
+    pollThread_ = std::thread( &TelemetryPoller::Run, this );
+}
+
+void TelemetryPoller::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        isStopRequested_ = true;
+    }
+
+    stopRequested_.notify_all();
+
+    if ( pollThread_.joinable() ) {
+        pollThread_.join();
+    }
+}
+
+void TelemetryPoller::Poll()
+{
+    laserDriver_->SendCommandBatch( batch_, LaserDriver::Telemetry );
+
+    for ( LaserDriver::command_batch_t::const_iterator entry = batch_.begin(); entry != batch_.end(); entry++ ) {
+
+        // Readers of a snapshot that did not take the reply query the laser themselves:
+        if ( !snapshots_[ entry->command ]->Write( entry->returnCode, entry->response ) &&
+             oversizedReplyCommands_.insert( entry->command ).second ) {
+
+            logger_->LogError( "TelemetryPoller::Poll(): Reply to '" + entry->command + "' too long for snapshot, reading it from the laser instead" );
+        }
+    }
+}
+
+void TelemetryPoller::Run()
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    while ( !isStopRequested_ ) {
+
+        const std::chrono::steady_clock::time_point nextPoll = std::chrono::steady_clock::now() + std::chrono::milliseconds( intervalMs_ );
+
+        lock.unlock();
+        Poll();
+        lock.lock();
+
+        while ( !isStopRequested_ && stopRequested_.wait_until( lock, nextPoll ) != std::cv_status::timeout ) {}
+    }
+}
+
+NAMESPACE_COBOLT_END
@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       TelemetryPoller.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__TELEMETRY_POLLER_H
+#define __COBOLT__TELEMETRY_POLLER_H
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "base.h"
+#include "LaserDriver.h"
+#include "ValueSnapshot.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Periodically refreshes the replies of a set of (volatile) get commands on a background
+ *        thread, so that readers can take the latest values from snapshots instead of querying the
+ *        laser themselves. All commands are sent as one batch per poll.
+ */
+class TelemetryPoller
+{
+public:
+
+    TelemetryPoller( LaserDriver* laserDriver, const int intervalMs, const Logger* logger );
+    ~TelemetryPoller();
+
+    /**
+     * \brief Adds the command to the set of polled commands and returns the snapshot it will be
+     *        polled into. Must be called before Start().
+     */
+    const ValueSnapshot* Subscribe( const std::string& getCommand );
+
+    void Start();
+    void Stop();
+
+private:
+
+    typedef std::map<std::string, ValueSnapshot*> snapshots_t;
+
+    void Poll();
+    void Run();
+
+    LaserDriver* laserDriver_;
+    const int intervalMs_;
+    const Logger* logger_;
+
+    snapshots_t snapshots_;
+    LaserDriver::command_batch_t batch_;
+    std::set<std::string> oversizedReplyCommands_; ///< Reported once each.
+
+    std::mutex mutex_;
+    std::condition_variable stopRequested_;
+    bool isStopRequested_;
+    std::thread pollThread_;
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__TELEMETRY_POLLER_H
\ No newline at end of file
@@ -0,0 +1,250 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       TraceRecorder.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#include <algorithm>
+#include "TraceRecorder.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+const char g_TraceMagic[] = "CBTR";
+const size_t g_TraceMagicLength = 4;
+const char g_TraceVersion = 1;
+const char g_TraceFlag_ResponseRequested = 1;
+
+/**
+ * Longest time recorded exchanges stay in the file buffer, i.e. what a crash may lose of the trace.
+ */
+const int g_TraceFlushIntervalMs = 1000;
+
+void AppendVarint( std::string& buffer, unsigned long long value )
+{
+    while ( value >= 0x80 ) {
+        buffer.push_back( (char) ( ( value & 0x7f ) | 0x80 ) );
+        value >>= 7;
+    }
+
+    buffer.push_back( (char) value );
+}
+
+void AppendString( std::string& buffer, const std::string& string )
+{
+    AppendVarint( buffer, string.length() );
+    buffer.append( string );
+}
+
+bool ReadVarint( std::istream& stream, unsigned long long& value )
+{
+    value = 0;
+
+    for ( int shift = 0; shift < 64; shift += 7 ) {
+
+        const int byte = stream.get();
+
+        if ( byte == std::char_traits<char>::eof() ) {
+            return false;
+        }
+
+        value |= ( (unsigned long long) ( byte & 0x7f ) << shift );
+
+        if ( ( byte & 0x80 ) == 0 ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Reads a length prefixed string, failing on a length beyond the end of the file (i.e. a
+ *        truncated or corrupt trace) rather than trying to allocate it.
+ */
+bool ReadString( std::istream& stream, const std::streamoff fileSize, std::string& string )
+{
+    unsigned long long length;
+
+    if ( !ReadVarint( stream, length ) ) {
+        return false;
+    }
+
+    const std::streamoff position = stream.tellg();
+
+    if ( position < 0 || length > (unsigned long long) ( fileSize - position ) ) {
+        return false;
+    }
+
+    string.resize( (size_t) length );
+
+    return ( length == 0 || stream.read( &string[ 0 ], (std::streamsize) length ) );
+}
+
+TraceRecorder::TraceRecorder() :
+    isOpen_( false ),
+    previousStartUs_( 0 )
+{}
+
+TraceRecorder::~TraceRecorder()
+{
+    Close();
+}
+
+int TraceRecorder::Open( const std::string& filePath )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    file_.open( filePath.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+
+    if ( !file_.is_open() ) {
+        return return_code::error;
+    }
+
+    file_.write( g_TraceMagic, g_TraceMagicLength );
+    file_.put( g_TraceVersion );
+
+    recordingStart_ = clock_t::now();
+    lastFlush_ = recordingStart_;
+    previousStartUs_ = 0;
+    isOpen_ = true;
+
+    return return_code::ok;
+}
+
+void TraceRecorder::Close()
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    isOpen_ = false;
+
+    if ( file_.is_open() ) {
+        file_.close();
+    }
+}
+
+/**
+ * \brief Lock-free, as it is asked on every exchange. Record() checks again under the lock.
+ */
+bool TraceRecorder::IsOpen() const
+{
+    return isOpen_;
+}
+
+/**
+ * \brief Records an exchange that started at the given time and completed now. The response is
+ *        NULL if none was requested. The file is flushed at least once a second, so that a crash
+ *        loses no more than that of the trace.
+ */
+void TraceRecorder::Record( const clock_t::time_point& start, const std::string& command, const int returnCode, const std::string* response )
+{
+    const clock_t::time_point end = clock_t::now();
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    if ( !file_.is_open() ) {
+        return;
+    }
+
+    const long long startUs = std::chrono::duration_cast<std::chrono::microseconds>( start - recordingStart_ ).count();
+    const long long durationUs = std::chrono::duration_cast<std::chrono::microseconds>( end - start ).count();
+
+    // Pipelined commands may be recorded out of start order, the delta is then zero:
+    const long long startDeltaUs = std::max( 0LL, startUs - previousStartUs_ );
+    previousStartUs_ += startDeltaUs;
+
+    buffer_.clear();
+    AppendVarint( buffer_, (unsigned long long) startDeltaUs );
+    AppendVarint( buffer_, (unsigned long long) std::max( 0LL, durationUs ) );
+    AppendVarint( buffer_, (unsigned long long) ( ( (long long) returnCode << 1 ) ^ ( (long long) returnCode >> 63 ) ) );
+    buffer_.push_back( response != NULL ? g_TraceFlag_ResponseRequested : 0 );
+    AppendString( buffer_, command );
+    AppendString( buffer_, ( response != NULL ? *response : std::string() ) );
+
+    file_.write( buffer_.data(), (std::streamsize) buffer_.length() );
+
+    if ( end - lastFlush_ >= std::chrono::milliseconds( g_TraceFlushIntervalMs ) ) {
+
+        file_.flush();
+        lastFlush_ = end;
+    }
+}
+
+int TraceRecorder::Load( const std::string& filePath, std::vector<TraceRecord>& records )
+{
+    std::ifstream file( filePath.c_str(), std::ios::in | std::ios::binary );
+
+    file.seekg( 0, std::ios::end );
+    const std::streamoff fileSize = file.tellg();
+    file.seekg( 0, std::ios::beg );
+
+    char magic[ g_TraceMagicLength ];
+
+    if ( !file.read( magic, g_TraceMagicLength ) || std::string( magic, g_TraceMagicLength ) != g_TraceMagic || file.get() != g_TraceVersion ) {
+        return return_code::error;
+    }
+
+    records.clear();
+
+    long long startUs = 0;
+
+    while ( file.peek() != std::char_traits<char>::eof() ) {
+
+        TraceRecord record;
+        unsigned long long startDeltaUs, durationUs, zigzagReturnCode;
+
+        if ( !ReadVarint( file, startDeltaUs ) ||
+             !ReadVarint( file, durationUs ) ||
+             !ReadVarint( file, zigzagReturnCode ) ) {
+            return return_code::error;
+        }
+
+        const int flags = file.get();
+
+        if ( flags == std::char_traits<char>::eof() || !ReadString( file, fileSize, record.command ) || !ReadString( file, fileSize, record.response ) ) {
+            return return_code::error;
+        }
+
+        startUs += (long long) startDeltaUs;
+
+        record.startUs = startUs;
+        record.durationUs = (long) durationUs;
+        record.returnCode = (int) ( (long long) ( zigzagReturnCode >> 1 ) ^ -(long long) ( zigzagReturnCode & 1 ) );
+        record.isResponseRequested = ( ( flags & g_TraceFlag_ResponseRequested ) != 0 );
+
+        records.push_back( record );
+    }
+
+    return return_code::ok;
+}
+
+NAMESPACE_COBOLT_END
@@ -0,0 +1,113 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       TraceRecorder.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__TRACE_RECORDER_H
+#define __COBOLT__TRACE_RECORDER_H
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "base.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief One command exchange on the wire, as recorded in a trace.
+ */
+struct TraceRecord
+{
+    TraceRecord() :
+        startUs( 0 ),
+        durationUs( 0 ),
+        returnCode( return_code::ok ),
+        isResponseRequested( false )
+    {}
+
+    long long startUs; ///< Since the start of the recording.
+    long durationUs;   ///< Until the reply, for pipelined commands including the wait behind earlier replies.
+    int returnCode;
+    bool isResponseRequested;
+    std::string command;
+    std::string response;
+};
+
+/**
+ * \brief Records the command exchanges of a session into a compact binary trace file, to be replayed
+ *        by ReplayLaserDriver.
+ *
+ * The file starts with the magic "CBTR" and a version byte. Each record then holds, as LEB128
+ * varints: the start time delta to the previous record [us], the duration [us], the zigzag encoded
+ * return code, a flags byte (bit 0: response requested), and the length prefixed command and
+ * response.
+ */
+class TraceRecorder
+{
+public:
+
+    typedef std::chrono::steady_clock clock_t;
+
+    TraceRecorder();
+    ~TraceRecorder();
+
+    int Open( const std::string& filePath );
+    void Close();
+    bool IsOpen() const;
+
+    void Record( const clock_t::time_point& start, const std::string& command, const int returnCode, const std::string* response );
+
+    /**
+     * \brief Reads all records of a trace file.
+     */
+    static int Load( const std::string& filePath, std::vector<TraceRecord>& records );
+
+private:
+
+    std::mutex mutex_;
+    std::ofstream file_;
+    std::atomic<bool> isOpen_; ///< Set under mutex_ by Open() and Close(), read without it by IsOpen().
+    clock_t::time_point recordingStart_;
+    clock_t::time_point lastFlush_;
+    long long previousStartUs_;
+    std::string buffer_;
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__TRACE_RECORDER_H
\ No newline at end of file
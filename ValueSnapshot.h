@@ -0,0 +1,175 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       ValueSnapshot.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__VALUE_SNAPSHOT_H
+#define __COBOLT__VALUE_SNAPSHOT_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "base.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief A short device reply and its return code, readable from any thread without taking a lock.
+ *
+ * Implemented as a sequence lock: a writer makes the sequence number odd while writing and even
+ * again when done, and readers retry if the sequence number was odd or changed while they copied
+ * the value. Readers never block writers.
+ */
+class ValueSnapshot
+{
+public:
+
+    static const size_t Capacity = 64;
+
+    ValueSnapshot() :
+        sequence_( 0 ),
+        returnCode_( return_code::error ),
+        length_( 0 )
+    {}
+
+    /**
+     * \brief True until the first write, and while the last written value did not fit.
+     */
+    bool IsEmpty() const
+    {
+        return ( sequence_.load( std::memory_order_acquire ) == 0 || length_.load( std::memory_order_relaxed ) > Capacity );
+    }
+
+    /**
+     * \brief Replaces the snapshot. Returns false if the value is longer than Capacity, in which case
+     *        the snapshot reads as empty until the next write, so that readers do not keep serving
+     *        the previous value.
+     */
+    bool Write( const int returnCode, const std::string& value )
+    {
+        const bool isFitting = ( value.length() <= Capacity );
+
+        // Concurrent writers are rare, they simply take turns:
+        unsigned sequence = sequence_.load( std::memory_order_relaxed );
+        while ( ( sequence & 1 ) != 0 || !sequence_.compare_exchange_weak( sequence, sequence + 1, std::memory_order_acquire ) ) {
+            std::this_thread::yield();
+            sequence = sequence_.load( std::memory_order_relaxed );
+        }
+        
+        std::atomic_thread_fence( std::memory_order_release );
+
+        returnCode_.store( returnCode, std::memory_order_relaxed );
+
+        if ( isFitting ) {
+
+            length_.store( value.length(), std::memory_order_relaxed );
+            for ( size_t i = 0; i < value.length(); i++ ) {
+                characters_[ i ].store( value[ i ], std::memory_order_relaxed );
+            }
+
+        } else {
+
+            length_.store( Capacity + 1, std::memory_order_relaxed );
+        }
+
+        sequence_.store( sequence + 2, std::memory_order_release );
+
+        return isFitting;
+    }
+
+    /**
+     * \brief Copies the snapshot. Returns false if nothing has been written yet, or if the last
+     *        written value did not fit.
+     */
+    bool Read( int& returnCode, std::string& value ) const
+    {
+        unsigned version;
+        return Read( returnCode, value, version );
+    }
+
+    /**
+     * \brief Copies the snapshot like above, and tells its version, which changes with every write.
+     */
+    bool Read( int& returnCode, std::string& value, unsigned& version ) const
+    {
+        char characters[ Capacity ];
+        size_t length;
+        unsigned sequenceBefore, sequenceAfter;
+
+        do {
+
+            sequenceBefore = sequence_.load( std::memory_order_acquire );
+            
+            if ( sequenceBefore == 0 ) {
+                return false;
+            }
+
+            if ( ( sequenceBefore & 1 ) != 0 ) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            returnCode = returnCode_.load( std::memory_order_relaxed );
+            length = length_.load( std::memory_order_relaxed );
+            for ( size_t i = 0; i < length && i < Capacity; i++ ) {
+                characters[ i ] = characters_[ i ].load( std::memory_order_relaxed );
+            }
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+            sequenceAfter = sequence_.load( std::memory_order_relaxed );
+
+        } while ( ( sequenceBefore & 1 ) != 0 || sequenceBefore != sequenceAfter );
+
+        if ( length > Capacity ) {
+            return false;
+        }
+
+        value.assign( characters, length );
+        version = sequenceBefore;
+
+        return true;
+    }
+
+private:
+
+    std::atomic<unsigned> sequence_;
+    std::atomic<int> returnCode_;
+    std::atomic<size_t> length_;
+    std::atomic<char> characters_[ Capacity ];
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__VALUE_SNAPSHOT_H
\ No newline at end of file
@@ -0,0 +1,292 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       WarmStartLaserDriver.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#include <assert.h>
+#include <fstream>
+#include "WarmStartLaserDriver.h"
+#include "Logger.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * Queries whose replies never change for a given unit and firmware. Skyra line variants (e.g. "1glm?")
+ * are covered by their line-less form.
+ */
+const char* const g_ImmutableQueries[] = { "gsn?", "gfv?", "glm?", "gmlc?", "gmlp?", "glw?" };
+
+WarmStartLaserDriver::WarmStartLaserDriver( LaserDriver* laserDriver, const std::string& filePath, const Logger* logger ) :
+    laserDriver_( laserDriver ),
+    filePath_( filePath ),
+    logger_( logger ),
+    isDirty_( false )
+{
+    assert( laserDriver_ != NULL );
+}
+
+int WarmStartLaserDriver::Validate()
+{
+    command_batch_t batch;
+    batch.push_back( BatchedCommand( "gsn?" ) );
+    batch.push_back( BatchedCommand( "gfv?" ) );
+
+    const int returnCode = laserDriver_->SendCommandBatch( batch );
+
+    if ( returnCode != return_code::ok ) {
+
+        logger_->LogError( "WarmStartLaserDriver::Validate(): Failed to identify laser" );
+        return returnCode;
+    }
+
+    entries_t loadedEntries;
+    const bool isFileValid = ( Load( loadedEntries ) &&
+                               loadedEntries[ "gsn?" ] == batch[ 0 ].response &&
+                               loadedEntries[ "gfv?" ] == batch[ 1 ].response );
+
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    if ( isFileValid ) {
+
+        COBOLT_LOG_DEBUG( logger_, "WarmStartLaserDriver::Validate(): Using cache file '" + filePath_ + "'" );
+        entries_.swap( loadedEntries );
+        isDirty_ = false;
+
+    } else {
+
+        COBOLT_LOG_DEBUG( logger_, "WarmStartLaserDriver::Validate(): Cache file '" + filePath_ + "' missing or not matching laser, starting over" );
+        entries_.clear();
+        entries_[ "gsn?" ] = batch[ 0 ].response;
+        entries_[ "gfv?" ] = batch[ 1 ].response;
+        isDirty_ = true;
+    }
+
+    return return_code::ok;
+}
+
+int WarmStartLaserDriver::Save()
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    if ( !isDirty_ ) {
+        return return_code::ok;
+    }
+
+    std::ofstream file( filePath_.c_str(), std::ios::out | std::ios::trunc );
+
+    for ( entries_t::const_iterator entry = entries_.begin(); entry != entries_.end(); entry++ ) {
+        file << entry->first << '\t' << entry->second << '\n';
+    }
+
+    if ( !file ) {
+
+        logger_->LogError( "WarmStartLaserDriver::Save(): Failed to write cache file '" + filePath_ + "'" );
+        return return_code::error;
+    }
+
+    isDirty_ = false;
+
+    return return_code::ok;
+}
+
+int WarmStartLaserDriver::SendCommand( const std::string& command, std::string* response )
+{
+    return SendCommand( command, response, Setpoint );
+}
+
+int WarmStartLaserDriver::SendCommand( const std::string& command, std::string* response, Priority priority )
+{
+    if ( !IsImmutableQuery( command ) ) {
+        return laserDriver_->SendCommand( command, response, priority );
+    }
+
+    std::string immutableResponse;
+    int returnCode = return_code::ok;
+
+    if ( !LookUp( command, immutableResponse ) ) {
+
+        returnCode = laserDriver_->SendCommand( command, &immutableResponse, priority );
+
+        if ( returnCode == return_code::ok ) {
+            Store( command, immutableResponse );
+        }
+    }
+
+    if ( response != NULL ) {
+        response->swap( immutableResponse );
+    }
+
+    return returnCode;
+}
+
+int WarmStartLaserDriver::SendCommandBatch( command_batch_t& batch )
+{
+    return SendCommandBatch( batch, Setpoint );
+}
+
+/**
+ * \brief Answers the cached commands of the batch directly and sends the rest as one smaller batch.
+ */
+int WarmStartLaserDriver::SendCommandBatch( command_batch_t& batch, Priority priority )
+{
+    command_batch_t forwardedBatch;
+    std::vector<size_t> forwardedIndices;
+
+    for ( size_t i = 0; i < batch.size(); i++ ) {
+
+        if ( IsImmutableQuery( batch[ i ].command ) && LookUp( batch[ i ].command, batch[ i ].response ) ) {
+
+            batch[ i ].returnCode = return_code::ok;
+
+        } else {
+
+            forwardedBatch.push_back( BatchedCommand( batch[ i ].command ) );
+            forwardedIndices.push_back( i );
+        }
+    }
+
+    if ( forwardedBatch.empty() ) {
+        return return_code::ok;
+    }
+
+    const int returnCode = laserDriver_->SendCommandBatch( forwardedBatch, priority );
+
+    for ( size_t i = 0; i < forwardedBatch.size(); i++ ) {
+
+        const BatchedCommand& reply = forwardedBatch[ i ];
+
+        if ( reply.returnCode == return_code::ok && IsImmutableQuery( reply.command ) ) {
+            Store( reply.command, reply.response );
+        }
+
+        batch[ forwardedIndices[ i ] ] = reply;
+    }
+
+    return returnCode;
+}
+
+void WarmStartLaserDriver::SendCommandAsync( const std::string& command, Completion* completion, Priority priority )
+{
+    std::string response;
+
+    if ( IsImmutableQuery( command ) && LookUp( command, response ) ) {
+
+        if ( completion != NULL ) {
+            completion->OnCommandCompleted( command, return_code::ok, response );
+        }
+
+        return;
+    }
+
+    laserDriver_->SendCommandAsync( command, completion, priority );
+}
+
+bool WarmStartLaserDriver::IsImmutableQuery( const std::string& command )
+{
+    const size_t lineNumberEnd = command.find_first_not_of( "0123456789" );
+
+    if ( lineNumberEnd == std::string::npos ) {
+        return false;
+    }
+
+    const std::string query = command.substr( lineNumberEnd );
+
+    for ( size_t i = 0; i < sizeof( g_ImmutableQueries ) / sizeof( g_ImmutableQueries[ 0 ] ); i++ ) {
+
+        if ( query == g_ImmutableQueries[ i ] ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief Reads the cache file, one 'command<TAB>response' entry per line.
+ */
+bool WarmStartLaserDriver::Load( entries_t& entries ) const
+{
+    std::ifstream file( filePath_.c_str() );
+
+    if ( !file ) {
+        return false;
+    }
+
+    std::string line;
+
+    while ( std::getline( file, line ) ) {
+
+        const size_t separator = line.find( '\t' );
+
+        if ( separator == std::string::npos ) {
+
+            logger_->LogError( "WarmStartLaserDriver::Load(): Malformed cache file '" + filePath_ + "'" );
+            return false;
+        }
+
+        entries[ line.substr( 0, separator ) ] = line.substr( separator + 1 );
+    }
+
+    return true;
+}
+
+bool WarmStartLaserDriver::LookUp( const std::string& command, std::string& response ) const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    entries_t::const_iterator entry = entries_.find( command );
+
+    if ( entry == entries_.end() ) {
+        return false;
+    }
+
+    response = entry->second;
+
+    return true;
+}
+
+void WarmStartLaserDriver::Store( const std::string& command, const std::string& response )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    std::string& entry = entries_[ command ];
+
+    if ( entry != response ) {
+
+        entry = response;
+        isDirty_ = true;
+    }
+}
+
+NAMESPACE_COBOLT_END
@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       WarmStartLaserDriver.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__WARM_START_LASER_DRIVER_H
+#define __COBOLT__WARM_START_LASER_DRIVER_H
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "base.h"
+#include "LaserDriver.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Answers queries for immutable laser data (model, serial number, firmware version, max
+ *        setpoints, wavelengths) from a cache file kept from a previous session with the same unit,
+ *        and passes everything else on to the wrapped driver.
+ *
+ * The file is only trusted if the serial number and firmware version it was written for match those
+ * of the connected laser, which Validate() checks with a single batched round trip. Replies missing
+ * from the file are fetched from the laser and written back by Save().
+ */
+class WarmStartLaserDriver : public LaserDriver
+{
+public:
+
+    WarmStartLaserDriver( LaserDriver* laserDriver, const std::string& filePath, const Logger* logger );
+
+    /**
+     * \brief Loads the cache file and checks it against the connected laser. A missing, unreadable
+     *        or mismatching file is discarded, and the cache starts over empty.
+     */
+    int Validate();
+
+    /**
+     * \brief Writes the cache file, if replies were added since it was loaded.
+     */
+    int Save();
+
+    /// ###
+    /// LaserDriver API
+
+    virtual int SendCommand( const std::string& command, std::string* response = NULL );
+    virtual int SendCommand( const std::string& command, std::string* response, Priority priority );
+    virtual int SendCommandBatch( command_batch_t& batch );
+    virtual int SendCommandBatch( command_batch_t& batch, Priority priority );
+    virtual void SendCommandAsync( const std::string& command, Completion* completion, Priority priority = Telemetry );
+
+private:
+
+    typedef std::map<std::string, std::string> entries_t;
+
+    static bool IsImmutableQuery( const std::string& command );
+
+    bool Load( entries_t& entries ) const;
+
+    bool LookUp( const std::string& command, std::string& response ) const;
+    void Store( const std::string& command, const std::string& response );
+
+    LaserDriver* laserDriver_;
+    std::string filePath_;
+    const Logger* logger_;
+
+    mutable std::mutex mutex_;
+    entries_t entries_;
+    bool isDirty_;
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__WARM_START_LASER_DRIVER_H
\ No newline at end of file
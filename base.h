@@ -58,6 +58,10 @@ namespace return_code
     const int invalid_value = 101004;
     const int property_not_settable_in_current_state = 101005;
     const int unsupported_device_property_value = 101006;
+    const int serial_port_timeout = 101007;
+
+    /// What Micro-Manager's serial port (SerialManager's ERR_TERM_TIMEOUT) returns when a reply did not arrive in time:
+    const int serial_manager_timeout = 10007;
 }
 
 #define COBOLT_MM_DRIVER_VERSION "1.0.2"
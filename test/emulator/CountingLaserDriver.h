@@ -0,0 +1,182 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       CountingLaserDriver.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__COUNTING_LASER_DRIVER_H
+#define __COBOLT__COUNTING_LASER_DRIVER_H
+
+#include <string>
+
+#include "base.h"
+#include "LaserDriver.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Forwards all traffic to another driver (typically a LaserEmulator) while tallying what it
+ *        would cost on a serial link: round trips, commands, bytes each way, and a modelled latency.
+ *
+ * A round trip is modelled as the laser's turnaround time plus the time the bytes take at the baud
+ * rate. Batches are modelled as pipelined like CoboltOfficial::SendCommandBatch() does, i.e. one round
+ * trip per PipelineDepth commands.
+ */
+class CountingLaserDriver : public LaserDriver
+{
+public:
+
+    static const int PipelineDepth = 8;
+
+    struct Tally
+    {
+        Tally() : roundTrips( 0 ), commands( 0 ), bytesSent( 0 ), bytesReceived( 0 ), modelledLatencyUs( 0 ) {}
+
+        int roundTrips;
+        int commands;
+        long bytesSent;
+        long bytesReceived;
+        long modelledLatencyUs;
+    };
+
+    CountingLaserDriver( LaserDriver* target, const long baudRate = 115200, const long turnaroundUs = 1000 ) :
+        target_( target ),
+        baudRate_( baudRate ),
+        turnaroundUs_( turnaroundUs )
+    {}
+
+    void Reset()
+    {
+        tally_ = Tally();
+    }
+
+    const Tally& GetTally() const
+    {
+        return tally_;
+    }
+
+    std::string FormatTally() const
+    {
+        return
+            std::to_string( (long long) tally_.roundTrips ) + " round trips, " +
+            std::to_string( (long long) tally_.commands ) + " commands, " +
+            std::to_string( (long long) tally_.bytesSent ) + " bytes sent, " +
+            std::to_string( (long long) tally_.bytesReceived ) + " bytes received, " +
+            std::to_string( (long long) tally_.modelledLatencyUs / 1000 ) + " ms modelled";
+    }
+
+    /// ###
+    /// LaserDriver API
+
+    virtual int SendCommand( const std::string& command, std::string* response = NULL )
+    {
+        std::string reply;
+        const int returnCode = target_->SendCommand( command, &reply );
+
+        // Composite commands cost one round trip per part:
+        size_t parts = 1;
+        for ( size_t i = command.find( '\r' ); i != std::string::npos && i + 1 < command.length(); i = command.find( '\r', i + 1 ) ) {
+            parts++;
+        }
+
+        const long bytes = Count( command, reply, (int) parts );
+        tally_.roundTrips += (int) parts;
+        tally_.modelledLatencyUs += (long) parts * turnaroundUs_ + GetTransferTimeUs( bytes );
+
+        if ( response != NULL ) {
+            response->swap( reply );
+        }
+
+        return returnCode;
+    }
+
+    virtual int SendCommandBatch( command_batch_t& batch )
+    {
+        int batchReturnCode = return_code::ok;
+        long windowBytes = 0;
+
+        for ( size_t i = 0; i < batch.size(); i++ ) {
+
+            BatchedCommand& entry = batch[ i ];
+
+            entry.response.clear();
+            entry.returnCode = target_->SendCommand( entry.command, &entry.response );
+            windowBytes += Count( entry.command, entry.response, 1 );
+
+            if ( entry.returnCode != return_code::ok && batchReturnCode == return_code::ok ) {
+                batchReturnCode = entry.returnCode;
+            }
+
+            if ( ( i + 1 ) % PipelineDepth == 0 || i + 1 == batch.size() ) {
+
+                tally_.roundTrips++;
+                tally_.modelledLatencyUs += turnaroundUs_ + GetTransferTimeUs( windowBytes );
+                windowBytes = 0;
+            }
+        }
+
+        return batchReturnCode;
+    }
+
+private:
+
+    /**
+     * \brief Counts the command and its reply, returning their size on the wire including terminators.
+     */
+    long Count( const std::string& command, const std::string& reply, const int parts )
+    {
+        const long sent = (long) command.length() + 1;
+        const long received = (long) reply.length() + 2 * parts;
+
+        tally_.commands += parts;
+        tally_.bytesSent += sent;
+        tally_.bytesReceived += received;
+
+        return ( sent + received );
+    }
+
+    long GetTransferTimeUs( const long bytes ) const
+    {
+        return ( bytes * 10 * 1000000 / baudRate_ ); // 10 bits per character (8N1).
+    }
+
+    LaserDriver* target_;
+    const long baudRate_;
+    const long turnaroundUs_;
+
+    Tally tally_;
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__COUNTING_LASER_DRIVER_H
\ No newline at end of file
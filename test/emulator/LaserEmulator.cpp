@@ -0,0 +1,572 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       LaserEmulator.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#include "LaserEmulator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+#include "CommandStatistics.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+namespace
+{
+    const char g_Reply_Ok[] = "OK";
+    const char g_Reply_IllegalCommand[] = "Syntax error: illegal command";
+    const char g_Reply_IllegalValue[] = "Syntax error: illegal value";
+
+    const char g_RunMode_ConstantCurrent[] = "0";
+    const char g_RunMode_ConstantPower[] = "1";
+    const char g_RunMode_Modulation[] = "2";
+
+    bool IsNumber( const std::string& text )
+    {
+        if ( text.empty() ) {
+            return false;
+        }
+
+        char* end;
+        strtod( text.c_str(), &end );
+
+        return ( *end == '\0' );
+    }
+
+    std::string FormatReading( const double value )
+    {
+        char buffer[ 32 ];
+        snprintf( buffer, sizeof( buffer ), "%.4f", value );
+
+        return buffer;
+    }
+
+    int IllegalCommand( std::string& response )
+    {
+        response = g_Reply_IllegalCommand;
+        return return_code::unsupported_command;
+    }
+
+    int IllegalValue( std::string& response )
+    {
+        response = g_Reply_IllegalValue;
+        return return_code::unsupported_command;
+    }
+
+    int Acknowledge( std::string& response )
+    {
+        response = g_Reply_Ok;
+        return return_code::ok;
+    }
+
+    int Answer( const std::string& value, std::string& response )
+    {
+        response = value;
+        return return_code::ok;
+    }
+
+    int SetNumber( const std::string& argument, std::string& setting, std::string& response )
+    {
+        if ( !IsNumber( argument ) ) {
+            return IllegalValue( response );
+        }
+
+        setting = argument;
+        return Acknowledge( response );
+    }
+
+    int SetFlag( const std::string& argument, std::string& setting, std::string& response )
+    {
+        if ( argument != "0" && argument != "1" ) {
+            return IllegalValue( response );
+        }
+
+        setting = argument;
+        return Acknowledge( response );
+    }
+}
+
+LaserEmulator::Line::Line() :
+    isPresent( false ),
+    isActive( false ),
+    runMode( g_RunMode_ConstantPower ),
+    currentSetpoint( "0" ),
+    powerSetpoint( "0" ),
+    modulationLowCurrentSetpoint( "0" ),
+    modulationHighCurrentSetpoint( "0" ),
+    maxCurrentSetpoint( "0" ),
+    maxPowerSetpoint( "0" )
+{}
+
+LaserEmulator::LaserEmulator( const Model model ) :
+    model_( model ),
+    isInCdrhMode_( false ),
+    isShutterCommandSupported_( model != Skyra ), // Skyra firmware has no shutter command yet
+    isKeyswitchEnabled_( true ),
+    warmUpTimeMs_( 0 ),
+    defaultLatencyUs_( 0 ),
+    commandCount_( 0 ),
+    serialNumber_( "12345" ),
+    isOn_( false ),
+    isAborted_( false ),
+    isShutterOpen_( false ),
+    digitalModulation_( "0" ),
+    analogModulation_( "0" ),
+    analogImpedance_( "0" ),
+    modulationPowerSetpoint_( "0" )
+{
+    Line& laser = lines_[ 0 ];
+    laser.isPresent = true;
+    laser.isActive = true;
+
+    switch ( model_ ) {
+
+        case Dpl06:
+
+            firmwareVersion_ = "4.2.1";
+            laser.model = "0532-06-91-0100-100";
+            laser.wavelength = "532";
+            laser.maxCurrentSetpoint = "3000.0";
+            laser.maxPowerSetpoint = "0.1000";
+            laser.currentSetpoint = "1500.0";
+            laser.powerSetpoint = "0.0500";
+            break;
+
+        case Mld06:
+
+            firmwareVersion_ = "4.2.1";
+            laser.model = "0488-06-01-0060-100";
+            laser.wavelength = "488";
+            laser.maxCurrentSetpoint = "100.0";
+            laser.maxPowerSetpoint = "0.0600";
+            laser.currentSetpoint = "50.0";
+            laser.powerSetpoint = "0.0300";
+            break;
+
+        case Skyra:
+        {
+            static const char* submodels[ SkyraLineCount ] = { "MLD-0405", "MLD-0488", "DPL-0561", "MLD-0638" };
+            static const char* wavelengths[ SkyraLineCount ] = { "405", "488", "561", "638" };
+
+            firmwareVersion_ = "9.001";
+            laser.model = "SKYRA-0405-0488-0561-0638";
+
+            for ( int i = 1; i <= SkyraLineCount; i++ ) {
+
+                Line& line = lines_[ i ];
+                line.isPresent = true;
+                line.isActive = true;
+                line.model = submodels[ i - 1 ];
+                line.wavelength = wavelengths[ i - 1 ];
+                line.maxCurrentSetpoint = "200.0";
+                line.maxPowerSetpoint = "0.0500";
+                line.currentSetpoint = "100.0";
+                line.powerSetpoint = "0.0250";
+            }
+
+            break;
+        }
+    }
+}
+
+void LaserEmulator::SetCdrhMode( const bool enabled )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    isInCdrhMode_ = enabled;
+}
+
+void LaserEmulator::SetShutterCommandSupported( const bool supported )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    isShutterCommandSupported_ = supported;
+}
+
+void LaserEmulator::SetKeyswitchEnabled( const bool enabled )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    isKeyswitchEnabled_ = enabled;
+}
+
+void LaserEmulator::SetWarmUpTimeMs( const int warmUpTimeMs )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    warmUpTimeMs_ = warmUpTimeMs;
+}
+
+void LaserEmulator::SetDefaultLatencyUs( const long latencyUs )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    defaultLatencyUs_ = latencyUs;
+}
+
+void LaserEmulator::SetLatencyUs( const std::string& opcode, const long latencyUs )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    latenciesUs_[ opcode ] = latencyUs;
+}
+
+unsigned long LaserEmulator::GetCommandCount() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+    return commandCount_;
+}
+
+unsigned long LaserEmulator::GetCommandCount( const std::string& opcode ) const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    std::map<std::string, unsigned long>::const_iterator count = commandCounts_.find( opcode );
+    return ( count != commandCounts_.end() ? count->second : 0 );
+}
+
+bool LaserEmulator::IsEmitting() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    for ( int i = 0; i <= SkyraLineCount; i++ ) {
+
+        if ( IsLineEmitting( lines_[ i ] ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int LaserEmulator::SendCommand( const std::string& command, std::string* response )
+{
+    std::string reply;
+    int returnCode = return_code::ok;
+    long latencyUs = 0;
+    const bool isComposite = ( command.find( '\r' ) != std::string::npos );
+
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+
+        // Split up into atomic commands if command is composite, as the wire drivers do. Only the
+        // '\r' terminated parts are sent, and no reply is handed over:
+        if ( isComposite ) {
+
+            size_t atomicCommandBegin = 0;
+
+            for ( size_t atomicCommandEnd = command.find( '\r' );
+                  atomicCommandEnd != std::string::npos && returnCode == return_code::ok;
+                  atomicCommandEnd = command.find( '\r', atomicCommandBegin ) ) {
+
+                returnCode = ExecuteAtomicCommand( command.substr( atomicCommandBegin, atomicCommandEnd - atomicCommandBegin ), reply, latencyUs );
+                atomicCommandBegin = atomicCommandEnd + 1;
+            }
+
+        } else {
+
+            returnCode = ExecuteAtomicCommand( command, reply, latencyUs );
+        }
+    }
+
+    // Waited out without holding the lock, so that concurrent callers are not serialized by it:
+    if ( latencyUs > 0 ) {
+        std::this_thread::sleep_for( std::chrono::microseconds( latencyUs ) );
+    }
+
+    if ( response != NULL && !isComposite ) {
+        *response = reply;
+    }
+
+    return returnCode;
+}
+
+/**
+ * \brief Counts and executes one command, adding its latency to the exchange's. Called with the
+ *        lock held.
+ */
+int LaserEmulator::ExecuteAtomicCommand( const std::string& command, std::string& response, long& latencyUs )
+{
+    const std::string opcode = CommandStatistics::GetOpcode( command );
+
+    commandCount_++;
+    commandCounts_[ opcode ]++;
+    latencyUs += GetLatencyUs( opcode );
+
+    return Execute( command, response );
+}
+
+int LaserEmulator::Execute( const std::string& command, std::string& response )
+{
+    // Skyra line commands are prefixed with the line number, e.g. '2glp?':
+    size_t opcodeBegin = 0;
+    int lineNumber = 0;
+
+    if ( command.length() > 1 && command[ 0 ] >= '0' && command[ 0 ] <= '9' &&
+         command[ 1 ] >= 'a' && command[ 1 ] <= 'z' ) {
+
+        lineNumber = command[ 0 ] - '0';
+        opcodeBegin = 1;
+    }
+
+    const size_t separator = command.find( ' ', opcodeBegin );
+    const std::string opcode = command.substr( opcodeBegin, ( separator == std::string::npos ? std::string::npos : separator - opcodeBegin ) );
+    const std::string argument = ( separator == std::string::npos ? "" : command.substr( separator + 1 ) );
+
+    if ( lineNumber == 0 ) {
+
+        const int returnCode = ExecuteLaserCommand( opcode, argument, response );
+
+        if ( returnCode != return_code::unsupported_command || response != g_Reply_IllegalCommand ) {
+            return returnCode;
+        }
+
+    } else if ( model_ != Skyra || lineNumber > SkyraLineCount || !lines_[ lineNumber ].isPresent ) {
+
+        return IllegalCommand( response );
+    }
+
+    return ExecuteLineCommand( lines_[ lineNumber ], opcode, argument, response );
+}
+
+int LaserEmulator::ExecuteLaserCommand( const std::string& opcode, const std::string& argument, std::string& response )
+{
+    /// ###
+    /// Identification
+
+    if ( opcode == "gfv?" ) { return Answer( firmwareVersion_, response ); }
+    if ( opcode == "gsn?" ) { return Answer( serialNumber_, response ); }
+    if ( opcode == "hrs?" ) { return Answer( "1234.56", response ); }
+    if ( opcode == "gas?" ) { return Answer( ( isInCdrhMode_ ? "1" : "0" ), response ); }
+    if ( opcode == "gkses?" ) { return Answer( ( isKeyswitchEnabled_ ? "1" : "0" ), response ); }
+
+    /// ###
+    /// Laser state
+
+    if ( opcode == "l?" ) { return Answer( ( isOn_ ? "1" : "0" ), response ); }
+    if ( opcode == "gom?" ) { return Answer( GetOperatingMode(), response ); }
+
+    if ( opcode == "restart" || opcode == "l1" ) {
+
+        if ( !isOn_ ) {
+            turnOnTime_ = clock_t::now();
+        }
+
+        isOn_ = true;
+        isAborted_ = false;
+        return Acknowledge( response );
+    }
+
+    if ( opcode == "l0" ) {
+
+        isOn_ = false;
+        return Acknowledge( response );
+    }
+
+    if ( opcode == "abort" ) {
+
+        isOn_ = false;
+        isAborted_ = true;
+        return Acknowledge( response );
+    }
+
+    if ( opcode == "l0r" || opcode == "l1r" ) {
+
+        if ( !isShutterCommandSupported_ ) {
+            return IllegalCommand( response );
+        }
+
+        isShutterOpen_ = ( opcode == "l1r" );
+        return Acknowledge( response );
+    }
+
+    /// ###
+    /// Modulation
+
+    if ( opcode == "gdmes?" ) { return Answer( digitalModulation_, response ); }
+    if ( opcode == "sdmes" ) { return SetFlag( argument, digitalModulation_, response ); }
+    if ( opcode == "games?" ) { return Answer( analogModulation_, response ); }
+    if ( opcode == "sames" ) { return SetFlag( argument, analogModulation_, response ); }
+    if ( opcode == "galis?" ) { return Answer( analogImpedance_, response ); }
+    if ( opcode == "salis" ) { return SetFlag( argument, analogImpedance_, response ); }
+    if ( opcode == "glmp?" ) { return Answer( modulationPowerSetpoint_, response ); }
+    if ( opcode == "slmp" ) { return SetNumber( argument, modulationPowerSetpoint_, response ); }
+
+    /// ###
+    /// Persistence
+
+    if ( opcode == "gdsn?" ) { return Answer( deviceString_, response ); }
+
+    if ( opcode == "sdsn" ) {
+
+        deviceString_ = argument;
+        return Acknowledge( response );
+    }
+
+    return IllegalCommand( response );
+}
+
+int LaserEmulator::ExecuteLineCommand( Line& line, const std::string& opcode, const std::string& argument, std::string& response )
+{
+    if ( opcode == "glm?" ) { return Answer( line.model, response ); }
+    if ( opcode == "glw?" ) { return Answer( line.wavelength, response ); }
+
+    if ( opcode == "gla?" ) { return Answer( ( line.isActive ? "1" : "0" ), response ); }
+
+    if ( opcode == "sla" ) {
+
+        if ( argument != "0" && argument != "1" ) {
+            return IllegalValue( response );
+        }
+
+        line.isActive = ( argument == "1" );
+        return Acknowledge( response );
+    }
+
+    /// ###
+    /// Run modes
+
+    if ( opcode == "gam?" ) { return Answer( line.runMode, response ); }
+    if ( opcode == "ecc" ) { line.runMode = g_RunMode_ConstantCurrent; return Acknowledge( response ); }
+    if ( opcode == "ecp" ) { line.runMode = g_RunMode_ConstantPower; return Acknowledge( response ); }
+    if ( opcode == "em" ) { line.runMode = g_RunMode_Modulation; return Acknowledge( response ); }
+
+    /// ###
+    /// Setpoints and readings
+
+    if ( opcode == "glc?" ) { return Answer( line.currentSetpoint, response ); }
+    if ( opcode == "slc" ) { return SetNumber( argument, line.currentSetpoint, response ); }
+    if ( opcode == "glp?" ) { return Answer( line.powerSetpoint, response ); }
+    if ( opcode == "slp" ) { return SetNumber( argument, line.powerSetpoint, response ); }
+    if ( opcode == "gmlc?" ) { return Answer( line.maxCurrentSetpoint, response ); }
+    if ( opcode == "gmlp?" ) { return Answer( line.maxPowerSetpoint, response ); }
+    if ( opcode == "glth?" ) { return Answer( line.modulationLowCurrentSetpoint, response ); }
+    if ( opcode == "slth" ) { return SetNumber( argument, line.modulationLowCurrentSetpoint, response ); }
+    if ( opcode == "gmc?" ) { return Answer( line.modulationHighCurrentSetpoint, response ); }
+    if ( opcode == "smc" ) { return SetNumber( argument, line.modulationHighCurrentSetpoint, response ); }
+
+    if ( opcode == "pa?" ) { return Answer( GetPowerReading( line ), response ); }
+    if ( opcode == "i?" ) { return Answer( GetCurrentReading( line ), response ); }
+
+    return IllegalCommand( response );
+}
+
+/**
+ * \brief The operating mode as reported by gom?: 0 = off, 1 = waiting for temperature, 2 = waiting for
+ *        key, 3 = warming up, 4 = completed, 6 = aborted.
+ */
+std::string LaserEmulator::GetOperatingMode() const
+{
+    if ( isAborted_ ) {
+        return "6";
+    }
+
+    if ( !isOn_ ) {
+        return "0";
+    }
+
+    if ( !isKeyswitchEnabled_ ) {
+        return "2";
+    }
+
+    if ( !isInCdrhMode_ ) {
+        return "4";
+    }
+
+    const long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>( clock_t::now() - turnOnTime_ ).count();
+
+    if ( elapsedMs * 3 < warmUpTimeMs_ ) {
+        return "1";
+    }
+
+    if ( elapsedMs < warmUpTimeMs_ ) {
+        return "3";
+    }
+
+    return "4";
+}
+
+bool LaserEmulator::IsLineEmitting( const Line& line ) const
+{
+    if ( !line.isPresent || !line.isActive || GetOperatingMode() != "4" ) {
+        return false;
+    }
+
+    if ( isShutterCommandSupported_ && !isShutterOpen_ ) {
+        return false;
+    }
+
+    if ( line.runMode == g_RunMode_ConstantCurrent ) {
+        return ( atof( line.currentSetpoint.c_str() ) > 0 );
+    }
+
+    return ( atof( line.powerSetpoint.c_str() ) > 0 );
+}
+
+std::string LaserEmulator::GetPowerReading( const Line& line ) const
+{
+    if ( !IsLineEmitting( line ) ) {
+        return FormatReading( 0 );
+    }
+
+    if ( line.runMode == g_RunMode_ConstantCurrent ) {
+
+        const double maxCurrent = atof( line.maxCurrentSetpoint.c_str() );
+        const double fraction = ( maxCurrent > 0 ? atof( line.currentSetpoint.c_str() ) / maxCurrent : 0 );
+
+        return FormatReading( fraction * atof( line.maxPowerSetpoint.c_str() ) );
+    }
+
+    return FormatReading( atof( line.powerSetpoint.c_str() ) );
+}
+
+std::string LaserEmulator::GetCurrentReading( const Line& line ) const
+{
+    if ( !IsLineEmitting( line ) ) {
+        return FormatReading( 0 );
+    }
+
+    if ( line.runMode == g_RunMode_ConstantCurrent ) {
+        return FormatReading( atof( line.currentSetpoint.c_str() ) );
+    }
+
+    const double maxPower = atof( line.maxPowerSetpoint.c_str() );
+    const double fraction = ( maxPower > 0 ? atof( line.powerSetpoint.c_str() ) / maxPower : 0 );
+
+    return FormatReading( fraction * atof( line.maxCurrentSetpoint.c_str() ) );
+}
+
+long LaserEmulator::GetLatencyUs( const std::string& opcode ) const
+{
+    std::map<std::string, long>::const_iterator latency = latenciesUs_.find( opcode );
+    return ( latency != latenciesUs_.end() ? latency->second : defaultLatencyUs_ );
+}
+
+NAMESPACE_COBOLT_END
@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       LaserEmulator.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__LASER_EMULATOR_H
+#define __COBOLT__LASER_EMULATOR_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "base.h"
+#include "LaserDriver.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Emulates the command protocol of a 06-DPL, 06-MLD or Skyra laser, so that the adapter can
+ *        be exercised and benchmarked without hardware.
+ *
+ * Covers the commands the adapter sends: identification, capability probing, run modes, setpoints,
+ * readings, modulation, the laser on/off and pause (l0r/l1r) commands, the CDRH operating mode
+ * sequence reported by gom?, the device string persistence (gdsn?/sdsn) used by the legacy no-shutter
+ * fix and, for Skyra, the line prefixed commands (e.g. '2sla 1'). Readings follow the state: power and
+ * current are only non-zero while the laser is emitting.
+ *
+ * Unknown commands are answered like the laser does, with a syntax error. Every command can be given
+ * a latency, which SendCommand() waits out before returning.
+ */
+class LaserEmulator : public LaserDriver
+{
+public:
+
+    enum Model { Dpl06, Mld06, Skyra };
+
+    static const int SkyraLineCount = 4;
+
+    LaserEmulator( const Model model );
+
+    /// ###
+    /// Configuration, to be done before the emulator is used.
+
+    void SetCdrhMode( const bool enabled );
+    void SetShutterCommandSupported( const bool supported );
+    void SetKeyswitchEnabled( const bool enabled );
+
+    /**
+     * \brief The time from the laser being turned on until gom? reports it completed, in CDRH mode.
+     */
+    void SetWarmUpTimeMs( const int warmUpTimeMs );
+
+    void SetDefaultLatencyUs( const long latencyUs );
+
+    /**
+     * \brief Sets the latency of the commands with the given opcode (see CommandStatistics::GetOpcode()).
+     */
+    void SetLatencyUs( const std::string& opcode, const long latencyUs );
+
+    /// ###
+    /// Inspection
+
+    unsigned long GetCommandCount() const;
+    unsigned long GetCommandCount( const std::string& opcode ) const;
+
+    bool IsEmitting() const;
+
+    /// ###
+    /// LaserDriver API
+
+    virtual int SendCommand( const std::string& command, std::string* response = NULL );
+
+private:
+
+    typedef std::chrono::steady_clock clock_t;
+
+    struct Line
+    {
+        Line();
+
+        bool isPresent;
+        bool isActive;
+        std::string model;
+        std::string wavelength;
+        std::string runMode;
+        std::string currentSetpoint;
+        std::string powerSetpoint;
+        std::string modulationLowCurrentSetpoint;
+        std::string modulationHighCurrentSetpoint;
+        std::string maxCurrentSetpoint;
+        std::string maxPowerSetpoint;
+    };
+
+    int ExecuteAtomicCommand( const std::string& command, std::string& response, long& latencyUs );
+    int Execute( const std::string& command, std::string& response );
+    int ExecuteLaserCommand( const std::string& opcode, const std::string& argument, std::string& response );
+    int ExecuteLineCommand( Line& line, const std::string& opcode, const std::string& argument, std::string& response );
+
+    std::string GetOperatingMode() const;
+    bool IsLineEmitting( const Line& line ) const;
+    std::string GetPowerReading( const Line& line ) const;
+    std::string GetCurrentReading( const Line& line ) const;
+
+    long GetLatencyUs( const std::string& opcode ) const;
+
+    const Model model_;
+
+    mutable std::mutex mutex_;
+
+    bool isInCdrhMode_;
+    bool isShutterCommandSupported_;
+    bool isKeyswitchEnabled_;
+    int warmUpTimeMs_;
+
+    long defaultLatencyUs_;
+    std::map<std::string, long> latenciesUs_;
+    std::map<std::string, unsigned long> commandCounts_;
+    unsigned long commandCount_;
+
+    std::string firmwareVersion_;
+    std::string serialNumber_;
+    std::string deviceString_;
+
+    bool isOn_;
+    bool isAborted_;
+    bool isShutterOpen_;
+    clock_t::time_point turnOnTime_;
+
+    std::string digitalModulation_;
+    std::string analogModulation_;
+    std::string analogImpedance_;
+    std::string modulationPowerSetpoint_;
+
+    Line lines_[ SkyraLineCount + 1 ]; ///< Line 0 is the laser itself.
+};
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__LASER_EMULATOR_H
\ No newline at end of file
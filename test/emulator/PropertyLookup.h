@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       PropertyLookup.h
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+#ifndef __COBOLT__PROPERTY_LOOKUP_H
+#define __COBOLT__PROPERTY_LOOKUP_H
+
+#include <string>
+
+#include "base.h"
+#include "Laser.h"
+
+NAMESPACE_COBOLT_BEGIN
+
+/**
+ * \brief Looks up a laser property by its name without the ordering prefix that Property adds
+ *        (e.g. "10-"). Returns NULL if the laser has no such property.
+ */
+inline Property* FindProperty( Laser* laser, const std::string& name )
+{
+    for ( Laser::PropertyIterator it = laser->GetPropertyIteratorBegin(); it != laser->GetPropertyIteratorEnd(); it++ ) {
+
+        const std::string::size_type separator = it->first.find( '-' );
+
+        if ( separator != std::string::npos && it->first.substr( separator + 1 ) == name ) {
+            return it->second;
+        }
+    }
+
+    return NULL;
+}
+
+NAMESPACE_COBOLT_END
+
+#endif // #ifndef __COBOLT__PROPERTY_LOOKUP_H
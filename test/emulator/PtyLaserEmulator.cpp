@@ -0,0 +1,383 @@
+///////////////////////////////////////////////////////////////////////////////
+// FILE:       PtyLaserEmulator.cpp
+// PROJECT:    MicroManager
+// SUBSYSTEM:  DeviceAdapters
+//-----------------------------------------------------------------------------
+// DESCRIPTION:
+// Cobolt Lasers Controller Adapter
+//
+// COPYRIGHT:     Cobolt AB, Stockholm, 2020
+//                All rights reserved
+//
+// LICENSE:       MIT
+//                Permission is hereby granted, free of charge, to any person obtaining a
+//                copy of this software and associated documentation files( the "Software" ),
+//                to deal in the Software without restriction, including without limitation the
+//                rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//                sell copies of the Software, and to permit persons to whom the Software is
+//                furnished to do so, subject to the following conditions:
+//                
+//                The above copyright notice and this permission notice shall be included in all
+//                copies or substantial portions of the Software.
+//
+//                THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+//                INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+//                PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+//                HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+//                OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+//                SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+// CAUTION:       Use of controls or adjustments or performance of any procedures other than those
+//                specified in owner's manual may result in exposure to hazardous radiation and
+//                violation of the CE / CDRH laser safety compliance.
+//
+// AUTHORS:       Lukas Kalinski / lukas.kalinski@coboltlasers.com (2020)
+//
+
+/**
+ * Serves a LaserEmulator on a pseudo-terminal, so that the adapter's real serial path (framing,
+ * flushing and timeouts of SendSerialCommand() and GetSerialAnswer()) can be exercised and measured
+ * end to end without hardware. Linux only.
+ *
+ * Build (from this directory):
+ *
+ *     g++ -std=c++11 -O2 -I../.. -o pty_laser_emulator PtyLaserEmulator.cpp LaserEmulator.cpp ../../CommandStatistics.cpp -lpthread
+ *
+ * Run 'pty_laser_emulator --help' for the options. The slave device path is printed on start-up;
+ * point the Micro-Manager serial port at it (or at the --link path).
+ */
+
+#if defined( _WIN32 )
+#error "PtyLaserEmulator is for POSIX systems only"
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "LaserEmulator.h"
+
+namespace
+{
+    const int g_BitsPerCharacter = 10; // Start bit, 8 data bits and stop bit.
+    const size_t g_MaxLineLength = 256;
+
+    volatile sig_atomic_t g_IsStopRequested = 0;
+
+    struct Options
+    {
+        Options() :
+            model( cobolt::LaserEmulator::Dpl06 ),
+            baudRate( 115200 ),
+            replyDelayUs( 0 ),
+            warmUpTimeMs( 0 ),
+            isInCdrhMode( false ),
+            isShutterCommandSupported( true ),
+            isShutterCommandSupportExplicit( false ),
+            isVerbose( false )
+        {}
+
+        cobolt::LaserEmulator::Model model;
+        long baudRate; ///< 0 disables throttling.
+        long replyDelayUs;
+        int warmUpTimeMs;
+        bool isInCdrhMode;
+        bool isShutterCommandSupported;
+        bool isShutterCommandSupportExplicit;
+        bool isVerbose;
+        std::string linkPath;
+    };
+
+    void OnStopSignal( int )
+    {
+        g_IsStopRequested = 1;
+    }
+
+    void PrintUsage( const char* program )
+    {
+        fprintf( stderr,
+            "Usage: %s [options]\n"
+            "  --model dpl|mld|skyra   Emulated laser model (default: dpl)\n"
+            "  --baud N                Throttle transfers to N baud, 0 for no throttling (default: 115200)\n"
+            "  --reply-delay-us N      Processing delay of every command (default: 0)\n"
+            "  --latency OPCODE=N      Processing delay of the given opcode, e.g. 'glm?=20000'\n"
+            "  --cdrh                  Run in CDRH mode\n"
+            "  --warm-up-ms N          Time from 'restart' until gom? reports completed, in CDRH mode\n"
+            "  --no-shutter-command    Reject l0r/l1r like older firmware does\n"
+            "  --shutter-command       Accept l0r/l1r (Skyra rejects them by default)\n"
+            "  --link PATH             Create a symbolic link to the slave device\n"
+            "  --verbose               Print every command and reply\n",
+            program );
+    }
+
+    bool ParseModel( const char* text, cobolt::LaserEmulator::Model& model )
+    {
+        if ( strcmp( text, "dpl" ) == 0 ) { model = cobolt::LaserEmulator::Dpl06; return true; }
+        if ( strcmp( text, "mld" ) == 0 ) { model = cobolt::LaserEmulator::Mld06; return true; }
+        if ( strcmp( text, "skyra" ) == 0 ) { model = cobolt::LaserEmulator::Skyra; return true; }
+
+        return false;
+    }
+
+    /**
+     * \brief Parses the command line into options and per-opcode latencies. Returns false on unknown
+     *        or malformed options.
+     */
+    bool ParseOptions( int argc, char* argv[], Options& options, std::vector<std::pair<std::string, long> >& latencies )
+    {
+        for ( int i = 1; i < argc; i++ ) {
+
+            const std::string option = argv[ i ];
+            const bool hasValue = ( i + 1 < argc );
+
+            if ( option == "--model" && hasValue ) {
+
+                if ( !ParseModel( argv[ ++i ], options.model ) ) {
+                    return false;
+                }
+
+            } else if ( option == "--baud" && hasValue ) {
+
+                options.baudRate = atol( argv[ ++i ] );
+
+            } else if ( option == "--reply-delay-us" && hasValue ) {
+
+                options.replyDelayUs = atol( argv[ ++i ] );
+
+            } else if ( option == "--latency" && hasValue ) {
+
+                const std::string latency = argv[ ++i ];
+                const size_t separator = latency.find( '=' );
+
+                if ( separator == std::string::npos ) {
+                    return false;
+                }
+
+                latencies.push_back( std::make_pair( latency.substr( 0, separator ), atol( latency.c_str() + separator + 1 ) ) );
+
+            } else if ( option == "--cdrh" ) {
+
+                options.isInCdrhMode = true;
+
+            } else if ( option == "--warm-up-ms" && hasValue ) {
+
+                options.warmUpTimeMs = atoi( argv[ ++i ] );
+
+            } else if ( option == "--no-shutter-command" || option == "--shutter-command" ) {
+
+                options.isShutterCommandSupported = ( option == "--shutter-command" );
+                options.isShutterCommandSupportExplicit = true;
+
+            } else if ( option == "--link" && hasValue ) {
+
+                options.linkPath = argv[ ++i ];
+
+            } else if ( option == "--verbose" ) {
+
+                options.isVerbose = true;
+
+            } else {
+
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Waits out the time the given number of characters take on a line at the given baud rate.
+     */
+    void Throttle( const size_t characterCount, const long baudRate )
+    {
+        if ( baudRate <= 0 || characterCount == 0 ) {
+            return;
+        }
+
+        const long long durationUs = (long long) characterCount * g_BitsPerCharacter * 1000000 / baudRate;
+        std::this_thread::sleep_for( std::chrono::microseconds( durationUs ) );
+    }
+
+    bool WriteAll( const int fd, const std::string& data )
+    {
+        size_t written = 0;
+
+        while ( written < data.length() ) {
+
+            const ssize_t result = write( fd, data.data() + written, data.length() - written );
+
+            if ( result < 0 ) {
+
+                if ( errno == EINTR || errno == EAGAIN ) {
+                    continue;
+                }
+
+                return false;
+            }
+
+            written += result;
+        }
+
+        return true;
+    }
+
+    int OpenPseudoTerminal( int& slaveFd, std::string& slavePath )
+    {
+        const int masterFd = posix_openpt( O_RDWR | O_NOCTTY );
+
+        if ( masterFd < 0 || grantpt( masterFd ) != 0 || unlockpt( masterFd ) != 0 ) {
+            return -1;
+        }
+
+        slavePath = ptsname( masterFd );
+
+        // Kept open so that the master does not see a hang-up whenever the client closes the port:
+        slaveFd = open( slavePath.c_str(), O_RDWR | O_NOCTTY );
+
+        if ( slaveFd < 0 ) {
+            close( masterFd );
+            return -1;
+        }
+
+        // Raw until the client configures the port, so that no '\r' is translated or echoed:
+        struct termios settings;
+        tcgetattr( slaveFd, &settings );
+        cfmakeraw( &settings );
+        tcsetattr( slaveFd, TCSANOW, &settings );
+
+        return masterFd;
+    }
+
+    /**
+     * \brief Executes one command line, and writes the reply the way the laser does: terminated with
+     *        "\r\n".
+     */
+    bool Serve( cobolt::LaserEmulator& emulator, const int masterFd, const std::string& command, const Options& options )
+    {
+        std::string reply;
+        emulator.SendCommand( command, &reply );
+        reply += "\r\n";
+
+        if ( options.isVerbose ) {
+            fprintf( stderr, "> %s\n< %s", command.c_str(), reply.c_str() );
+        }
+
+        // The command has been received character by character already, but is only accounted for
+        // here, together with the reply:
+        Throttle( command.length() + 1 + reply.length(), options.baudRate );
+
+        return WriteAll( masterFd, reply );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    Options options;
+    std::vector<std::pair<std::string, long> > latencies;
+
+    if ( !ParseOptions( argc, argv, options, latencies ) ) {
+        PrintUsage( argv[ 0 ] );
+        return EXIT_FAILURE;
+    }
+
+    cobolt::LaserEmulator emulator( options.model );
+    emulator.SetCdrhMode( options.isInCdrhMode );
+    emulator.SetWarmUpTimeMs( options.warmUpTimeMs );
+    emulator.SetDefaultLatencyUs( options.replyDelayUs );
+
+    if ( options.isShutterCommandSupportExplicit ) {
+        emulator.SetShutterCommandSupported( options.isShutterCommandSupported );
+    }
+
+    for ( size_t i = 0; i < latencies.size(); i++ ) {
+        emulator.SetLatencyUs( latencies[ i ].first, latencies[ i ].second );
+    }
+
+    int slaveFd;
+    std::string slavePath;
+    const int masterFd = OpenPseudoTerminal( slaveFd, slavePath );
+
+    if ( masterFd < 0 ) {
+        fprintf( stderr, "Failed to open a pseudo-terminal: %s\n", strerror( errno ) );
+        return EXIT_FAILURE;
+    }
+
+    if ( !options.linkPath.empty() ) {
+
+        unlink( options.linkPath.c_str() );
+
+        if ( symlink( slavePath.c_str(), options.linkPath.c_str() ) != 0 ) {
+            fprintf( stderr, "Failed to link '%s': %s\n", options.linkPath.c_str(), strerror( errno ) );
+            return EXIT_FAILURE;
+        }
+    }
+
+    signal( SIGINT, OnStopSignal );
+    signal( SIGTERM, OnStopSignal );
+
+    printf( "%s\n", slavePath.c_str() );
+    fflush( stdout );
+
+    std::string line;
+    char buffer[ 256 ];
+
+    while ( !g_IsStopRequested ) {
+
+        struct pollfd pollFd = { masterFd, POLLIN, 0 };
+        const int pollResult = poll( &pollFd, 1, 100 );
+
+        if ( pollResult <= 0 ) {
+            continue;
+        }
+
+        const ssize_t count = read( masterFd, buffer, sizeof( buffer ) );
+
+        if ( count <= 0 ) {
+
+            if ( count < 0 && errno != EINTR && errno != EAGAIN && errno != EIO ) {
+                break;
+            }
+
+            continue;
+        }
+
+        for ( ssize_t i = 0; i < count; i++ ) {
+
+            const char character = buffer[ i ];
+
+            if ( character == '\r' ) {
+
+                if ( !line.empty() && !Serve( emulator, masterFd, line, options ) ) {
+                    g_IsStopRequested = 1;
+                }
+
+                line.clear();
+
+            } else if ( character != '\n' && line.length() < g_MaxLineLength ) {
+
+                line += character;
+            }
+        }
+    }
+
+    if ( !options.linkPath.empty() ) {
+        unlink( options.linkPath.c_str() );
+    }
+
+    close( slaveFd );
+    close( masterFd );
+
+    return EXIT_SUCCESS;
+}
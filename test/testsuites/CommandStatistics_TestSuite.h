@@ -0,0 +1,67 @@
+/**
+ * \file        CommandStatistics_TestSuite.h
+ *
+ * \authors     Lukas Kalinski
+ *
+ * \copyright   Cobolt AB, 2020. All rights reserved.
+ */
+
+#include <cxxtest/TestSuite.h>
+#include "CommandStatistics.h"
+
+using namespace cobolt;
+
+class CommandStatistics_TestSuite : public CxxTest::TestSuite
+{
+    CommandStatistics* _statistics;
+
+    /**
+     * \brief Records an exchange the way CoboltOfficial does, from the return code of the wire.
+     */
+    void RecordExchange( const std::string& command, const int returnCode )
+    {
+        _statistics->Record( command, 1000, CommandStatistics::ResolveOutcome( returnCode ) );
+    }
+
+public:
+
+    void setUp()
+    {
+        _statistics = new CommandStatistics();
+    }
+
+    void tearDown()
+    {
+        delete _statistics;
+    }
+
+    void test_Record_serialManagerTimeout()
+    {
+        RecordExchange( "glp?", return_code::serial_manager_timeout );
+
+        const CommandStatistics::Summary total = _statistics->GetTotal();
+
+        TS_ASSERT_EQUALS( total.count, 1UL );
+        TS_ASSERT_EQUALS( total.timeoutCount, 1UL );
+        TS_ASSERT_EQUALS( total.errorCount, 0UL );
+    }
+
+    void test_Record_posixTimeout()
+    {
+        RecordExchange( "glp?", return_code::serial_port_timeout );
+
+        TS_ASSERT_EQUALS( _statistics->GetTotal().timeoutCount, 1UL );
+    }
+
+    void test_Record_error()
+    {
+        RecordExchange( "bogus", return_code::unsupported_command );
+        RecordExchange( "glp?", return_code::ok );
+
+        const CommandStatistics::Summary total = _statistics->GetTotal();
+
+        TS_ASSERT_EQUALS( total.count, 2UL );
+        TS_ASSERT_EQUALS( total.timeoutCount, 0UL );
+        TS_ASSERT_EQUALS( total.errorCount, 1UL );
+    }
+};
@@ -8,13 +8,17 @@
 
 #include <cxxtest/TestSuite.h>
 #include "Laser.h"
+#include "LaserFactory.h"
+#include "LaserShutterProperty.h"
+#include "../emulator/LaserEmulator.h"
+#include "../emulator/PropertyLookup.h"
 
 using namespace cobolt;
 
 class GuiPropertyMock : public GuiProperty
 {
 public:
-    
+
     GuiPropertyMock( const std::string& string ) :
         value( string )
     {}
@@ -24,98 +28,143 @@ public:
     std::string value;
 };
 
-class Laser_TestSuite : public CxxTest::TestSuite, public LaserDriver
+class Laser_TestSuite : public CxxTest::TestSuite
 {
-    struct PhysicalLaserMock
-    {
-        PhysicalLaserMock() :
-            firmwareVersion( "1.2.3" ),
-            isOn( false ),
-            isPauseCommandSupported( true )
-        {}
-
-        std::string firmwareVersion;
-        bool isOn;
-        bool isPauseCommandSupported;
-    };
-
-    PhysicalLaserMock _physicalLaserMock;
+    LaserEmulator* _emulator;
     Laser* _someLaser;
-    std::string _lastReceivedCommand;
+
+    /**
+     * \brief Asks the emulated laser directly, bypassing the laser object under test.
+     */
+    std::string QueryPhysicalLaser( const std::string& command )
+    {
+        std::string response;
+        _emulator->SendCommand( command, &response );
+        return response;
+    }
+
+    bool IsPhysicalLaserOn()
+    {
+        return ( QueryPhysicalLaser( "l?" ) == "1" );
+    }
 
 public:
 
     void setUp()
     {
-        _someLaser = Laser::Create( this );
-        _lastReceivedCommand.clear();
+        _emulator = new LaserEmulator( LaserEmulator::Dpl06 );
+        _someLaser = LaserFactory::Create( _emulator, Logger::Detached() );
+
+        TS_ASSERT( _someLaser != NULL );
     }
 
     void tearDown()
     {
         delete _someLaser;
+        delete _emulator;
     }
 
     void test_GetProperty_firmware()
     {
-        TS_ASSERT_EQUALS( _someLaser->GetProperty( "Firmware Version" )->GetValue(), _physicalLaserMock.firmwareVersion );
+        Property* property = FindProperty( _someLaser, "Firmware Version" );
+        TS_ASSERT( property != NULL );
+        if ( property == NULL ) { return; }
+
+        TS_ASSERT_EQUALS( property->GetValue(), QueryPhysicalLaser( "gfv?" ) );
     }
 
-    void test_OnGuiSetAction_toggle_on()
+    void test_SetOn_on()
     {
         /// ###
         /// Setup
 
         _someLaser->SetOn( false );
-        GuiPropertyMock guiProperty( "On" );
-        
+
         /// ###
         /// Verify Setup
 
-        TS_ASSERT( !_someLaser->IsOn() );
-        
+        TS_ASSERT( !IsPhysicalLaserOn() );
+
         /// ###
         /// Test
 
-        _someLaser->GetProperty( "On-Off Switch" )->OnGuiSetAction( guiProperty );
+        _someLaser->SetOn( true );
 
         /// ###
         /// Verify
-        
-        TS_ASSERT( _physicalLaserMock.isOn );
+
+        TS_ASSERT( IsPhysicalLaserOn() );
     }
 
-    void test_OnGuiSetAction_toggle_off()
+    void test_SetOn_off()
     {
         /// ###
         /// Setup
 
-        _physicalLaserMock.isOn = true;
-        GuiPropertyMock guiProperty( "Off" );
+        _someLaser->SetOn( true );
 
         /// ###
         /// Test
 
-        _someLaser->GetProperty( "On-Off Switch" )->OnGuiSetAction( guiProperty );
+        _someLaser->SetOn( false );
 
         /// ###
         /// Verify
 
-        TS_ASSERT( !_physicalLaserMock.isOn );
+        TS_ASSERT( !IsPhysicalLaserOn() );
     }
 
-    /// ###
-    /// Laser Device API
+    void test_OnGuiSetAction_shutter_open()
+    {
+        /// ###
+        /// Setup
+
+        _someLaser->SetOn( true );
+        GuiPropertyMock guiProperty( LaserShutterProperty::Value_Open );
+
+        Property* property = FindProperty( _someLaser, "Emission Status" );
+        TS_ASSERT( property != NULL );
+        if ( property == NULL ) { return; }
+
+        /// ###
+        /// Verify Setup
+
+        TS_ASSERT( !_emulator->IsEmitting() );
 
-    virtual int SendCommand( const std::string& command, std::string* response = NULL )
+        /// ###
+        /// Test
+
+        TS_ASSERT_EQUALS( property->OnGuiSetAction( guiProperty ), return_code::ok );
+
+        /// ###
+        /// Verify
+
+        TS_ASSERT( _emulator->IsEmitting() );
+        TS_ASSERT( _someLaser->IsShutterOpen() );
+    }
+
+    void test_OnGuiSetAction_shutter_close()
     {
-        if ( command == "gfv?" ) { *response = _physicalLaserMock.firmwareVersion; }
-        if ( command == "l1" )   { _physicalLaserMock.isOn = true; }
-        if ( command == "l0" )   { _physicalLaserMock.isOn = false; }
-        if ( command == "glm?" ) { *response = "0485-06-01"; }
-        
-        _lastReceivedCommand = command;
-
-        return cobolt::return_code::ok;
+        /// ###
+        /// Setup
+
+        _someLaser->SetOn( true );
+        _someLaser->SetShutterOpen( true );
+        GuiPropertyMock guiProperty( LaserShutterProperty::Value_Closed );
+
+        Property* property = FindProperty( _someLaser, "Emission Status" );
+        TS_ASSERT( property != NULL );
+        if ( property == NULL ) { return; }
+
+        /// ###
+        /// Test
+
+        TS_ASSERT_EQUALS( property->OnGuiSetAction( guiProperty ), return_code::ok );
+
+        /// ###
+        /// Verify
+
+        TS_ASSERT( !_emulator->IsEmitting() );
+        TS_ASSERT( !_someLaser->IsShutterOpen() );
     }
-};
\ No newline at end of file
+};
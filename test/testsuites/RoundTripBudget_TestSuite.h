@@ -0,0 +1,197 @@
+/**
+ * \file        RoundTripBudget_TestSuite.h
+ *
+ * \authors     Lukas Kalinski
+ *
+ * \copyright   Cobolt AB, 2020. All rights reserved.
+ */
+
+#include <cxxtest/TestSuite.h>
+#include "Laser.h"
+#include "LaserFactory.h"
+#include "NoShutterCommandLegacyFix.h"
+#include "../emulator/CountingLaserDriver.h"
+#include "../emulator/LaserEmulator.h"
+#include "../emulator/PropertyLookup.h"
+
+using namespace cobolt;
+
+/**
+ * Serial transaction budgets of the high-level operations. The budgets are the current costs; a test
+ * failing here means a change made the operation talk more to the laser. Lower the budget when an
+ * operation gets cheaper.
+ */
+class RoundTripBudget_TestSuite : public CxxTest::TestSuite
+{
+    struct Budget
+    {
+        int roundTrips;
+        long modelledLatencyMs;
+    };
+
+    LaserEmulator* _emulator;
+    CountingLaserDriver* _driver;
+    Laser* _laser;
+
+    void CreateLaser( const LaserEmulator::Model model, const bool isInCdrhMode, const bool isShutterCommandSupported = true )
+    {
+        _emulator = new LaserEmulator( model );
+        _emulator->SetCdrhMode( isInCdrhMode );
+
+        if ( model != LaserEmulator::Skyra ) {
+            _emulator->SetShutterCommandSupported( isShutterCommandSupported );
+        }
+
+        _driver = new CountingLaserDriver( _emulator );
+        _laser = LaserFactory::Create( _driver, Logger::Detached() );
+
+        TS_ASSERT( _laser != NULL );
+    }
+
+    void VerifyBudget( const std::string& operation, const Budget& budget )
+    {
+        const CountingLaserDriver::Tally& tally = _driver->GetTally();
+
+        TS_TRACE( operation + ": " + _driver->FormatTally() );
+        TS_ASSERT_LESS_THAN_EQUALS( tally.roundTrips, budget.roundTrips );
+        TS_ASSERT_LESS_THAN_EQUALS( tally.modelledLatencyUs / 1000, budget.modelledLatencyMs );
+    }
+
+    void VerifyCreateBudget( const LaserEmulator::Model model, const bool isInCdrhMode, const std::string& operation, const Budget& budget )
+    {
+        CreateLaser( model, isInCdrhMode );
+        VerifyBudget( operation, budget );
+    }
+
+    void VerifyOpenShutterBudget( const LaserEmulator::Model model, const bool isInCdrhMode, const bool isShutterCommandSupported,
+                                  const std::string& operation, const Budget& budget )
+    {
+        CreateLaser( model, isInCdrhMode, isShutterCommandSupported );
+        _laser->SetOn( true );
+        _driver->Reset();
+
+        _laser->SetShutterOpen( true );
+
+        VerifyBudget( operation, budget );
+    }
+
+public:
+
+    void setUp()
+    {
+        _emulator = NULL;
+        _driver = NULL;
+        _laser = NULL;
+    }
+
+    void tearDown()
+    {
+        delete _laser;
+        delete _driver;
+        delete _emulator;
+    }
+
+    /// ###
+    /// Initialization
+
+    void test_Create_Dpl06()
+    {
+        const Budget budget = { 4, 25 };
+        VerifyCreateBudget( LaserEmulator::Dpl06, false, "LaserFactory::Create() 06-DPL", budget );
+    }
+
+    void test_Create_Dpl06_Cdrh()
+    {
+        const Budget budget = { 3, 23 };
+        VerifyCreateBudget( LaserEmulator::Dpl06, true, "LaserFactory::Create() 06-DPL CDRH", budget );
+    }
+
+    void test_Create_Mld06()
+    {
+        const Budget budget = { 4, 25 };
+        VerifyCreateBudget( LaserEmulator::Mld06, false, "LaserFactory::Create() 06-MLD", budget );
+    }
+
+    void test_Create_Skyra()
+    {
+        const Budget budget = { 8, 35 };
+        VerifyCreateBudget( LaserEmulator::Skyra, false, "LaserFactory::Create() Skyra", budget );
+    }
+
+    /// ###
+    /// Emission
+
+    void test_SetOn()
+    {
+        CreateLaser( LaserEmulator::Dpl06, false );
+        _driver->Reset();
+
+        _laser->SetOn( true );
+
+        const Budget budget = { 3, 5 };
+        VerifyBudget( "Laser::SetOn()", budget );
+    }
+
+    void test_SetShutterOpen_Oem()
+    {
+        const Budget budget = { 2, 3 };
+        VerifyOpenShutterBudget( LaserEmulator::Dpl06, false, true, "Laser::SetShutterOpen() OEM", budget );
+        TS_ASSERT( _emulator->IsEmitting() );
+    }
+
+    void test_SetShutterOpen_Cdrh()
+    {
+        const Budget budget = { 2, 3 };
+        VerifyOpenShutterBudget( LaserEmulator::Dpl06, true, true, "Laser::SetShutterOpen() CDRH", budget );
+        TS_ASSERT( _emulator->IsEmitting() );
+    }
+
+    void test_SetShutterOpen_NoShutterCommand()
+    {
+        const Budget budget = { 2, 3 };
+        VerifyOpenShutterBudget( LaserEmulator::Mld06, false, false, "Laser::SetShutterOpen() without shutter command", budget );
+        TS_ASSERT( _emulator->IsEmitting() );
+    }
+
+    void test_SetShutterOpen_Skyra()
+    {
+        CreateLaser( LaserEmulator::Skyra, false );
+        _laser->SetOn( true );
+
+        using legacy::no_shutter_command::skyra::LineActivationProperty;
+
+        // With the shutter closed, activating a line is only recorded, and opening the shutter applies it:
+        LineActivationProperty* lineActivation = dynamic_cast<LineActivationProperty*>( FindProperty( _laser, "Line 1" ) );
+        TSM_ASSERT( "Line 1 activation property not found", lineActivation != NULL );
+        if ( lineActivation == NULL ) { return; }
+
+        TS_ASSERT_EQUALS( lineActivation->SetValue( LineActivationProperty::Value_Active ), return_code::ok );
+        TS_ASSERT( !_emulator->IsEmitting() );
+        _driver->Reset();
+
+        _laser->SetShutterOpen( true );
+
+        const Budget budget = { 2, 3 };
+        VerifyBudget( "Laser::SetShutterOpen() Skyra", budget );
+        TS_ASSERT( _emulator->IsEmitting() );
+    }
+
+    /// ###
+    /// Refresh
+
+    void test_PropertyRefresh()
+    {
+        CreateLaser( LaserEmulator::Dpl06, false );
+        _driver->Reset();
+
+        // As a GUI refresh sweep does it (see CoboltOfficial::UpdateStatus()):
+        _laser->PrefetchValues();
+
+        for ( Laser::PropertyIterator it = _laser->GetPropertyIteratorBegin(); it != _laser->GetPropertyIteratorEnd(); it++ ) {
+            it->second->GetValue();
+        }
+
+        const Budget budget = { 2, 16 };
+        VerifyBudget( "Full property refresh", budget );
+    }
+};
\ No newline at end of file